@@ -0,0 +1,95 @@
+// 灰度提取微基准测试
+// 比较LumaConverter与QImage::convertToFormat(Format_Grayscale8)在各像素格式下的耗时
+// 用法：LumaBenchmark [宽度] [高度] [次数]
+
+#include "LumaConverter.h"
+#include <QElapsedTimer>
+#include <QImage>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+namespace {
+
+// 以随机像素填充图像，使转换不受图像内容影响；
+// 预乘透明度的格式opaque为true时全部不透明，否则为随机透明度的有效预乘像素
+QImage RandomImage(int width, int height, QImage::Format format, bool opaque)
+{
+    QImage img(width, height, format);
+    if (format == QImage::Format_Indexed8)
+    {
+        QVector<QRgb> colors(256);
+        for (auto &color : colors)
+            color = QRandomGenerator::global()->generate() | 0xFF000000;
+        img.setColorTable(colors);
+    }
+    for (int y = 0; y < height; y++)
+    {
+        auto line = reinterpret_cast<quint32 *>(img.scanLine(y));
+        QRandomGenerator::global()->fillRange(line, img.bytesPerLine() / 4);
+        if (format == QImage::Format_ARGB32_Premultiplied || format == QImage::Format_RGBA8888_Premultiplied)
+        {
+            // 两种格式的透明度均在最高字节（RGBA8888按小端序），分量不大于透明度即为有效的预乘像素
+            for (int x = 0; x < width; x++)
+                line[x] = opaque ? line[x] | 0xFF000000 : qPremultiply(line[x]);
+        }
+    }
+    return img;
+}
+
+template<typename Func>
+double Measure(int iterations, Func func)
+{
+    func();     // 预热
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; i++)
+        func();
+    return timer.nsecsElapsed() / 1e6 / iterations;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int width = argc > 1 ? QString(argv[1]).toInt() : 1920;
+    int height = argc > 2 ? QString(argv[2]).toInt() : 1080;
+    int iterations = argc > 3 ? QString(argv[3]).toInt() : 100;
+
+    struct Case
+    {
+        QImage::Format format;
+        const char *name;
+        bool opaque;
+    };
+    const QList<Case> cases = {
+        { QImage::Format_ARGB32_Premultiplied, "ARGB32_Premultiplied", true },
+        { QImage::Format_ARGB32_Premultiplied, "ARGB32_Premultiplied(a)", false },
+        { QImage::Format_RGBA8888_Premultiplied, "RGBA8888_Premultiplied", true },
+        { QImage::Format_RGBA8888_Premultiplied, "RGBA8888_Premultiplied(a)", false },
+        { QImage::Format_RGB30, "RGB30", true },
+        { QImage::Format_BGR30, "BGR30", true },
+        { QImage::Format_RGB16, "RGB16", true },
+        { QImage::Format_Grayscale16, "Grayscale16", true },
+        { QImage::Format_Indexed8, "Indexed8", true },
+    };
+
+    QTextStream out(stdout);
+    out << QString("%1x%2, %3 iterations\n").arg(width).arg(height).arg(iterations);
+    out << QString("%1 %2 %3 %4\n").arg("Format", -24).arg("Qt(ms)", 10).arg("Luma(ms)", 10).arg("Speedup", 8);
+
+    std::vector<uint8_t> buffer;
+    for (auto &[format, name, opaque] : cases)
+    {
+        auto img = RandomImage(width, height, format, opaque);
+        // 不支持的格式返回空视图，计时没有意义
+        if (!LumaConverter::convert(img, buffer).data())
+        {
+            out << QString("%1 %2\n").arg(name, -24).arg("unsupported");
+            continue;
+        }
+        double qt = Measure(iterations, [&] { img.convertToFormat(QImage::Format_Grayscale8); });
+        double luma = Measure(iterations, [&] { LumaConverter::convert(img, buffer); });
+        out << QString("%1 %2 %3 %4x\n").arg(name, -24).arg(qt, 10, 'f', 3).arg(luma, 10, 'f', 3).arg(qt / luma, 7, 'f', 2);
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include "BinarizerTuner.h"
+#include <QMutexLocker>
+
+// 命中率相差在该值以内时视为相同，选择耗时较短的算法
+static constexpr double RateTolerance = 0.05;
+
+BinarizerTuner::BinarizerTuner()
+{
+    m_lockedTimer.start();
+}
+
+void BinarizerTuner::setSampleFrames(int frames)
+{
+    QMutexLocker locker(&m_mutex);
+    m_sampleFrames = qMax(1, frames);
+}
+
+void BinarizerTuner::setReevaluateInterval(int ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_reevaluate = qMax(0, ms);
+}
+
+ZXing::Binarizer BinarizerTuner::select()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_locked)
+    {
+        if (m_lockedTimer.elapsed() < m_reevaluate)
+            return m_best;
+        // 到期后清除统计重新采样
+        m_locked = false;
+        m_stats = {};
+        m_next = 0;
+    }
+
+    auto binarizer = Candidates[m_next];
+    m_next = (m_next + 1) % static_cast<int>(Candidates.size());
+    return binarizer;
+}
+
+void BinarizerTuner::record(ZXing::Binarizer binarizer, bool hit, double ms)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_locked)
+        return;
+
+    for (size_t i = 0; i < Candidates.size(); i++)
+    {
+        if (Candidates[i] != binarizer)
+            continue;
+        auto &s = m_stats[i];
+        s.attempts++;
+        s.hits += hit ? 1 : 0;
+        s.totalTime += ms;
+    }
+
+    chooseLocked();
+}
+
+void BinarizerTuner::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats = {};
+    m_best = ZXing::Binarizer::LocalAverage;
+    m_locked = false;
+    m_next = 0;
+}
+
+bool BinarizerTuner::isLocked() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_locked;
+}
+
+ZXing::Binarizer BinarizerTuner::current() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_best;
+}
+
+std::array<BinarizerTuner::Stats, BinarizerTuner::Candidates.size()> BinarizerTuner::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+const char *BinarizerTuner::name(ZXing::Binarizer binarizer)
+{
+    switch (binarizer)
+    {
+    case ZXing::Binarizer::LocalAverage: return "LocalAverage";
+    case ZXing::Binarizer::GlobalHistogram: return "GlobalHistogram";
+    case ZXing::Binarizer::FixedThreshold: return "FixedThreshold";
+    case ZXing::Binarizer::BoolCast: return "BoolCast";
+    }
+    return "";
+}
+
+void BinarizerTuner::chooseLocked()
+{
+    quint64 hits = 0;
+    for (auto &s : m_stats)
+    {
+        if (s.attempts < static_cast<quint64>(m_sampleFrames))
+            return;
+        hits += s.hits;
+    }
+    // 采样期间没有条码时无法比较，清除统计重新采样
+    if (hits == 0)
+    {
+        m_stats = {};
+        return;
+    }
+
+    int best = -1;
+    double bestRate = 0.0, bestTime = 0.0;
+    for (size_t i = 0; i < Candidates.size(); i++)
+    {
+        auto &s = m_stats[i];
+        double rate = double(s.hits) / s.attempts;
+        double time = s.totalTime / s.attempts;
+        if (best < 0 || rate > bestRate + RateTolerance || (rate > bestRate - RateTolerance && time < bestTime))
+        {
+            best = static_cast<int>(i);
+            bestRate = rate;
+            bestTime = time;
+        }
+    }
+
+    m_best = Candidates[best];
+    m_locked = true;
+    m_lockedTimer.restart();
+}
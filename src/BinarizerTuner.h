@@ -0,0 +1,58 @@
+#pragma once
+
+#include <ZXing/ReaderOptions.h>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <array>
+
+// 二值化算法自动选择
+// 采样阶段各帧轮流使用不同的二值化算法，统计各算法的命中率与耗时，
+// 采样足够后选定命中率最高（相近时耗时最短）的算法，并每隔一段时间重新采样
+class BinarizerTuner
+{
+public:
+    // 参与自动选择的算法，BoolCast只适用于已二值化的图像，不参与
+    static constexpr std::array<ZXing::Binarizer, 3> Candidates = {
+        ZXing::Binarizer::LocalAverage,
+        ZXing::Binarizer::GlobalHistogram,
+        ZXing::Binarizer::FixedThreshold,
+    };
+
+    struct Stats
+    {
+        quint64 attempts = 0;   // 识别次数
+        quint64 hits = 0;       // 识别到结果的次数
+        double totalTime = 0.0; // 累计耗时(ms)
+    };
+
+    BinarizerTuner();
+
+    // 每个算法的采样帧数
+    void setSampleFrames(int frames);
+    // 选定后重新采样的间隔(ms)
+    void setReevaluateInterval(int ms);
+
+    // 返回本帧使用的二值化算法
+    ZXing::Binarizer select();
+    // 记录本帧识别结果
+    void record(ZXing::Binarizer binarizer, bool hit, double ms);
+    void reset();
+
+    bool isLocked() const;
+    ZXing::Binarizer current() const;
+    std::array<Stats, Candidates.size()> stats() const;
+
+    static const char *name(ZXing::Binarizer binarizer);
+
+private:
+    void chooseLocked();
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_lockedTimer;
+    std::array<Stats, Candidates.size()> m_stats;
+    ZXing::Binarizer m_best = ZXing::Binarizer::LocalAverage;
+    bool m_locked = false;
+    int m_next = 0;             // 采样阶段下一帧使用的算法
+    int m_sampleFrames = 10;
+    int m_reevaluate = 60000;
+};
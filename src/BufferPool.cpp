@@ -0,0 +1,102 @@
+#include "BufferPool.h"
+#include <atomic>
+
+namespace {
+
+std::atomic<quint64> s_acquired { 0 };
+std::atomic<quint64> s_allocated { 0 };
+
+} // namespace
+
+BufferPool::Buffer::Buffer(Buffer &&other) noexcept
+    : m_pool(other.m_pool)
+    , m_data(std::move(other.m_data))
+{
+    other.m_pool = nullptr;
+}
+
+BufferPool::Buffer &BufferPool::Buffer::operator=(Buffer &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        m_pool = other.m_pool;
+        m_data = std::move(other.m_data);
+        other.m_pool = nullptr;
+    }
+    return *this;
+}
+
+BufferPool::Buffer::~Buffer()
+{
+    release();
+}
+
+void BufferPool::Buffer::release()
+{
+    if (m_pool)
+        m_pool->release(std::move(m_data));
+    m_pool = nullptr;
+}
+
+BufferPool &BufferPool::local()
+{
+    thread_local BufferPool pool;
+    return pool;
+}
+
+BufferPool::Buffer BufferPool::acquire(size_t size)
+{
+    s_acquired++;
+
+    // 优先使用容量足够的最小内存块，否则扩大最大的内存块
+    auto best = m_free.end();
+    auto largest = m_free.end();
+    for (auto it = m_free.begin(); it != m_free.end(); ++it)
+    {
+        if (it->capacity() >= size && (best == m_free.end() || it->capacity() < best->capacity()))
+            best = it;
+        if (largest == m_free.end() || it->capacity() > largest->capacity())
+            largest = it;
+    }
+    auto chosen = best != m_free.end() ? best : largest;
+
+    Buffer buffer;
+    buffer.m_pool = this;
+    if (chosen != m_free.end())
+    {
+        buffer.m_data = std::move(*chosen);
+        m_free.erase(chosen);
+    }
+    if (buffer.m_data.capacity() < size)
+    {
+        s_allocated++;
+        buffer.m_data.reserve(size);
+    }
+    return buffer;
+}
+
+BufferPool::Stats BufferPool::stats()
+{
+    return { s_acquired.load(), s_allocated.load() };
+}
+
+void BufferPool::release(std::vector<uint8_t> &&data)
+{
+    if (data.capacity() == 0)
+        return;
+    if (m_free.size() >= MaxFree)
+    {
+        // 超出保留数量时替换最小的内存块
+        auto smallest = m_free.begin();
+        for (auto it = m_free.begin(); it != m_free.end(); ++it)
+        {
+            if (it->capacity() < smallest->capacity())
+                smallest = it;
+        }
+        if (smallest->capacity() >= data.capacity())
+            return;
+        m_free.erase(smallest);
+    }
+    m_free.push_back(std::move(data));
+}
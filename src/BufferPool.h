@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QtGlobal>
+#include <cstdint>
+#include <vector>
+
+// 识别线程的帧缓冲池
+// 每个线程各有一个缓冲池，帧大小的临时内存用完后归还并在下一帧复用，稳定运行时不再分配内存；
+// 全局统计申请与实际分配的次数
+class BufferPool
+{
+public:
+    // 从缓冲池借出的内存，析构时归还，必须在借出的线程中析构
+    class Buffer
+    {
+    public:
+        Buffer() = default;
+        Buffer(Buffer &&other) noexcept;
+        Buffer &operator=(Buffer &&other) noexcept;
+        ~Buffer();
+
+        Buffer(const Buffer &) = delete;
+        Buffer &operator=(const Buffer &) = delete;
+
+        // 容量不小于申请的大小，调整到该大小以内不会重新分配
+        std::vector<uint8_t> &storage() { return m_data; }
+
+    private:
+        friend class BufferPool;
+        void release();
+
+        BufferPool *m_pool = nullptr;
+        std::vector<uint8_t> m_data;
+    };
+
+    struct Stats
+    {
+        quint64 acquired = 0;   // 申请次数
+        quint64 allocated = 0;  // 实际分配内存的次数
+    };
+
+    // 当前线程的缓冲池
+    static BufferPool &local();
+    // 申请容量不小于size字节的内存
+    Buffer acquire(size_t size);
+
+    static Stats stats();
+
+private:
+    BufferPool() = default;
+    void release(std::vector<uint8_t> &&data);
+
+    // 每个线程保留的空闲内存块数
+    static constexpr size_t MaxFree = 16;
+
+    std::vector<std::vector<uint8_t>> m_free;
+};
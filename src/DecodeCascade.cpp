@@ -0,0 +1,93 @@
+#include "DecodeCascade.h"
+#include "DecodeResults.h"
+#include "VariantDecoder.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+ZXing::Barcodes DecodeCascade::decode(const ZXing::ImageView &image, const ZXing::ReaderOptions &options, bool parallel,
+    QThreadPool *pool, QDeadlineTimer deadline)
+{
+    auto fast = ZXing::ReaderOptions(options)
+        .setTryHarder(false)
+        .setTryRotate(false)
+        .setTryInvert(false);
+
+    // 各级参数，未启用的选项对应的级别跳过
+    std::array<bool, TierCount> enabled = {
+        true,
+        options.tryRotate(),
+        options.tryInvert(),
+        // 旋转与反色组合或深度扫描只能由完整参数覆盖
+        options.tryHarder() || (options.tryRotate() && options.tryInvert()),
+    };
+    // 并行识别时所有变体在完整参数一级中同时进行
+    if (parallel && (options.tryRotate() || options.tryInvert()))
+        enabled = { true, false, false, true };
+
+    // 各级均未解码成功时返回最后一级定位到的条码
+    ZXing::Barcodes failed;
+    for (int tier = Fast; tier < TierCount; tier++)
+    {
+        if (!enabled[tier])
+            continue;
+        // 快速识别总是进行，其余级别在截止时间后跳过
+        if (tier != Fast && deadline.hasExpired())
+        {
+            recordSkipped(tier);
+            break;
+        }
+
+        auto opts = fast;
+        if (tier == Rotate)
+            opts.setTryRotate(true);
+        else if (tier == Invert)
+            opts.setTryInvert(true);
+        else if (tier == Full)
+            opts = options;
+
+        QElapsedTimer timer;
+        timer.start();
+        auto results = tier == Full && parallel ? VariantDecoder::decode(image, opts, pool, deadline) : ZXing::ReadBarcodes(image, opts);
+        bool hit = HasValidResult(results);
+        record(tier, hit, timer.nsecsElapsed() / 1e6);
+
+        if (hit)
+            return results;
+        if (!results.empty())
+            failed = std::move(results);
+    }
+    return failed;
+}
+
+std::array<DecodeCascade::TierStats, DecodeCascade::TierCount> DecodeCascade::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+void DecodeCascade::resetStats()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats = {};
+}
+
+const char *DecodeCascade::tierName(int tier)
+{
+    static const char *names[TierCount] = { "Fast", "Rotate", "Invert", "Full" };
+    return tier >= 0 && tier < TierCount ? names[tier] : "";
+}
+
+void DecodeCascade::record(int tier, bool hit, double ms)
+{
+    QMutexLocker locker(&m_mutex);
+    auto &s = m_stats[tier];
+    s.attempts++;
+    s.hits += hit ? 1 : 0;
+    s.totalTime += ms;
+}
+
+void DecodeCascade::recordSkipped(int tier)
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats[tier].skipped++;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <ZXing/ReadBarcode.h>
+#include <QDeadlineTimer>
+#include <QMutex>
+#include <array>
+
+class QThreadPool;
+
+// 分级识别
+// 先以关闭深度扫描、旋转与反色的快速参数识别，未识别到时逐级启用代价更高的参数，
+// 最后一级为用户设置的完整参数，并统计各级的命中率与耗时；
+// 启用并行时旋转与反色变体在完整参数一级中并行识别
+class DecodeCascade
+{
+public:
+    enum Tier
+    {
+        Fast,       // 快速识别
+        Rotate,     // 尝试旋转
+        Invert,     // 尝试反色
+        Full,       // 完整参数
+        TierCount
+    };
+
+    struct TierStats
+    {
+        quint64 attempts = 0;   // 识别次数
+        quint64 hits = 0;       // 识别到结果的次数
+        double totalTime = 0.0; // 累计耗时(ms)
+        quint64 skipped = 0;    // 超过截止时间而跳过的次数
+    };
+
+    DecodeCascade() = default;
+
+    // 按级识别，options为用户设置的完整参数，pool为并行识别使用的线程池，可在任意线程调用；
+    // 超过截止时间后不再开始后续级别
+    ZXing::Barcodes decode(const ZXing::ImageView &image, const ZXing::ReaderOptions &options, bool parallel = false,
+        QThreadPool *pool = nullptr, QDeadlineTimer deadline = QDeadlineTimer(QDeadlineTimer::Forever));
+
+    std::array<TierStats, TierCount> stats() const;
+    void resetStats();
+    static const char *tierName(int tier);
+
+private:
+    void record(int tier, bool hit, double ms);
+    void recordSkipped(int tier);
+
+    mutable QMutex m_mutex;
+    std::array<TierStats, TierCount> m_stats;
+};
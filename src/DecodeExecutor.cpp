@@ -0,0 +1,206 @@
+#include "DecodeExecutor.h"
+#include <QMutexLocker>
+#include <QStringList>
+#include <QThread>
+
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+namespace {
+
+// 后台任务线程在继承的nice值上增加的值
+constexpr int BatchNice = 10;
+
+#if defined(Q_OS_LINUX)
+// 启动时继承的CPU亲和性与nice值（如taskset、nice启动），恢复默认设置时还原到这里
+struct InheritedSchedule
+{
+    cpu_set_t cores;
+    int nice = 0;
+
+    InheritedSchedule()
+    {
+        if (sched_getaffinity(0, sizeof(cores), &cores) != 0)
+        {
+            CPU_ZERO(&cores);
+            for (int i = 0; i < CPU_SETSIZE; i++)
+                CPU_SET(i, &cores);
+        }
+        errno = 0;
+        int value = getpriority(PRIO_PROCESS, 0);
+        if (errno == 0)
+            nice = value;
+    }
+};
+
+// 静态初始化在主线程中进行，早于任何工作线程
+const InheritedSchedule Inherited;
+#endif
+
+void ApplyPriority(bool low)
+{
+#if defined(Q_OS_LINUX)
+    // Linux普通调度策略下QThread优先级无效，使用线程的nice值；普通用户无法恢复更高的优先级，失败时忽略
+    int nice = low ? qMin(19, Inherited.nice + BatchNice) : Inherited.nice;
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice);
+#else
+    QThread::currentThread()->setPriority(low ? QThread::LowPriority : QThread::NormalPriority);
+#endif
+}
+
+void ApplyAffinity(const QList<int> &cores)
+{
+#if defined(Q_OS_LINUX)
+    // 未指定核心时还原继承的亲和性，指定时只取其中允许的核心
+    cpu_set_t set = Inherited.cores;
+    if (!cores.isEmpty())
+    {
+        CPU_ZERO(&set);
+        for (int core : cores)
+        {
+            if (core >= 0 && core < CPU_SETSIZE && CPU_ISSET(core, &Inherited.cores))
+                CPU_SET(core, &set);
+        }
+        if (CPU_COUNT(&set) == 0)
+            return;
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#elif defined(Q_OS_WIN)
+    DWORD_PTR processMask = 0, systemMask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask))
+        return;
+    DWORD_PTR mask = 0;
+    for (int core : cores)
+    {
+        if (core >= 0 && core < int(sizeof(DWORD_PTR) * 8))
+            mask |= DWORD_PTR(1) << core;
+    }
+    mask = cores.isEmpty() ? processMask : mask & processMask;
+    if (mask)
+        SetThreadAffinityMask(GetCurrentThread(), mask);
+#else
+    Q_UNUSED(cores);
+#endif
+}
+
+} // namespace
+
+DecodeThreadPool::DecodeThreadPool(QObject *parent)
+    : QThreadPool(parent)
+{
+}
+
+void DecodeThreadPool::setLowPriority(bool low)
+{
+    QMutexLocker locker(&m_mutex);
+    m_lowPriority = low;
+    m_generation++;
+}
+
+void DecodeThreadPool::setCores(const QList<int> &cores)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cores = cores;
+    m_generation++;
+}
+
+void DecodeThreadPool::prepareThread()
+{
+    // 每个工作线程只属于一个线程池，记录已应用的设置版本
+    thread_local const DecodeThreadPool *appliedPool = nullptr;
+    thread_local int appliedGeneration = -1;
+
+    QMutexLocker locker(&m_mutex);
+    if (appliedPool == this && appliedGeneration == m_generation)
+        return;
+    bool low = m_lowPriority;
+    auto cores = m_cores;
+    appliedPool = this;
+    appliedGeneration = m_generation;
+    locker.unlock();
+
+    ApplyPriority(low);
+    ApplyAffinity(cores);
+}
+
+DecodeExecutor::DecodeExecutor()
+{
+    m_batch.setLowPriority(true);
+    setWorkerCount(0);
+}
+
+DecodeExecutor::~DecodeExecutor()
+{
+    waitForDone();
+}
+
+void DecodeExecutor::setWorkerCount(int workers)
+{
+    if (workers <= 0)
+        workers = QThread::idealThreadCount();
+    m_live.setMaxThreadCount(workers);
+    m_batch.setMaxThreadCount(qMax(1, workers / 2));
+}
+
+int DecodeExecutor::workerCount() const
+{
+    return m_live.maxThreadCount();
+}
+
+void DecodeExecutor::setCores(const QList<int> &cores)
+{
+    m_live.setCores(cores);
+    m_batch.setCores(cores);
+}
+
+void DecodeExecutor::start(Priority priority, const std::function<void()> &task)
+{
+    auto pool = static_cast<DecodeThreadPool *>(this->pool(priority));
+    pool->start([pool, task] {
+        pool->prepareThread();
+        task();
+        });
+}
+
+QThreadPool *DecodeExecutor::pool(Priority priority)
+{
+    return priority == Batch ? &m_batch : &m_live;
+}
+
+void DecodeExecutor::waitForDone()
+{
+    m_live.waitForDone();
+    m_batch.waitForDone();
+}
+
+QList<int> DecodeExecutor::parseCores(const QString &text)
+{
+    QList<int> cores;
+    for (auto &part : text.split(',', Qt::SkipEmptyParts))
+    {
+        auto range = part.split('-');
+        if (range.size() > 2)
+            continue;
+        bool ok = false;
+        int first = range[0].trimmed().toInt(&ok);
+        int last = first;
+        if (ok && range.size() == 2)
+            last = range[1].trimmed().toInt(&ok);
+        if (!ok || first < 0 || last < first)
+            continue;
+        for (int core = first; core <= last && core < 1024; core++)
+        {
+            if (!cores.contains(core))
+                cores.append(core);
+        }
+    }
+    return cores;
+}
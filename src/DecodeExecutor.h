@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <functional>
+
+// 识别专用线程池
+// 工作线程开始任务前按设置调整自身的优先级与绑定的CPU核心，设置改变后在下一个任务开始时生效
+class DecodeThreadPool : public QThreadPool
+{
+public:
+    explicit DecodeThreadPool(QObject *parent = nullptr);
+
+    // 低优先级用于后台批量任务
+    void setLowPriority(bool low);
+    // 绑定的CPU核心编号，为空时不限制
+    void setCores(const QList<int> &cores);
+
+    // 在工作线程中调用，使当前线程的优先级与CPU绑定符合设置
+    void prepareThread();
+
+private:
+    QMutex m_mutex;
+    QList<int> m_cores;
+    bool m_lowPriority = false;
+    int m_generation = 0;   // 设置版本，线程记录已应用的版本
+};
+
+// 识别执行器
+// 相机实时帧与图片文件等批量任务分别在两个专用线程池中运行，不占用Qt全局线程池；
+// 批量任务使用较低的系统优先级，两个线程池可绑定到指定的CPU核心
+class DecodeExecutor
+{
+public:
+    enum Priority
+    {
+        Live,   // 相机实时帧
+        Batch,  // 图片文件等后台任务
+    };
+
+    DecodeExecutor();
+    ~DecodeExecutor();
+
+    // 实时识别的线程数，0表示使用CPU核心数；批量任务使用其一半的线程
+    void setWorkerCount(int workers);
+    int workerCount() const;
+    void setCores(const QList<int> &cores);
+
+    void start(Priority priority, const std::function<void()> &task);
+    // 任务所在的线程池，任务内部的并行识别也应使用该线程池
+    QThreadPool *pool(Priority priority);
+    void waitForDone();
+
+    // 解析"0-3,6"形式的CPU核心列表，无效的部分被忽略
+    static QList<int> parseCores(const QString &text);
+
+private:
+    DecodeThreadPool m_live;
+    DecodeThreadPool m_batch;
+};
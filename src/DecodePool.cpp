@@ -0,0 +1,76 @@
+#include "DecodePool.h"
+#include "ScanLane.h"
+#include <QMutexLocker>
+#include <QThread>
+
+DecodePool::DecodePool(int maxWorkers)
+{
+    setMaxWorkers(maxWorkers);
+}
+
+void DecodePool::setMaxWorkers(int workers)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxWorkers = workers > 0 ? workers : qMax(1, QThread::idealThreadCount());
+}
+
+int DecodePool::maxWorkers() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxWorkers;
+}
+
+void DecodePool::addLane(const std::shared_ptr<ScanLane> &lane)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_lanes.contains(lane))
+        m_lanes.append(lane);
+}
+
+void DecodePool::removeLane(const std::shared_ptr<ScanLane> &lane)
+{
+    QMutexLocker locker(&m_mutex);
+    m_lanes.removeAll(lane);
+    if (m_cursor >= m_lanes.size())
+        m_cursor = 0;
+}
+
+QList<std::shared_ptr<ScanLane>> DecodePool::lanes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_lanes;
+}
+
+int DecodePool::laneCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_lanes.size();
+}
+
+bool DecodePool::next(std::shared_ptr<ScanLane> &lane, ScanFrame &frame)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_inFlight >= m_maxWorkers)
+        return false;
+
+    const int count = m_lanes.size();
+    for (int i = 0; i < count; i++)
+    {
+        int index = (m_cursor + i) % count;
+        if (m_lanes[index]->mailbox.take(frame))
+        {
+            // 下一次从后一个通道开始，保证各通道轮流获得识别线程
+            m_cursor = (index + 1) % count;
+            m_inFlight++;
+            lane = m_lanes[index];
+            return true;
+        }
+    }
+    return false;
+}
+
+void DecodePool::done()
+{
+    QMutexLocker locker(&m_mutex);
+    m_inFlight--;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QList>
+#include <QMutex>
+#include <memory>
+
+#include "FrameMailbox.h"
+
+struct ScanLane;
+
+// 多路相机共享的识别调度
+// 限制同时识别的总帧数，并按轮询顺序从各通道取帧，避免繁忙的相机占满识别线程
+class DecodePool
+{
+public:
+    explicit DecodePool(int maxWorkers = 0);
+
+    // 同时识别的最大帧数，0表示使用CPU核心数
+    void setMaxWorkers(int workers);
+    int maxWorkers() const;
+
+    void addLane(const std::shared_ptr<ScanLane> &lane);
+    void removeLane(const std::shared_ptr<ScanLane> &lane);
+    QList<std::shared_ptr<ScanLane>> lanes() const;
+    int laneCount() const;
+
+    // 按轮询顺序取出下一个待识别的帧，达到并发上限或没有待识别的帧时返回false
+    bool next(std::shared_ptr<ScanLane> &lane, ScanFrame &frame);
+    // 一帧识别完成，必须与成功的next()成对调用
+    void done();
+
+private:
+    mutable QMutex m_mutex;
+    QList<std::shared_ptr<ScanLane>> m_lanes;
+    int m_cursor = 0;       // 下一次开始轮询的通道
+    int m_maxWorkers = 1;
+    int m_inFlight = 0;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <ZXing/Barcode.h>
+#include <algorithm>
+#include <iterator>
+
+// 识别结果筛选
+// 启用ReaderOptions::returnErrors时结果中还包含已定位但未能解码的条码，
+// 判断是否识别成功时只统计解码成功的条码
+
+// 是否有解码成功的条码
+inline bool HasValidResult(const ZXing::Barcodes &results)
+{
+    return std::any_of(results.begin(), results.end(), [](const ZXing::Barcode &b) { return b.isValid(); });
+}
+
+// 从results中移出未能解码的条码并返回，results中只保留解码成功的条码
+inline ZXing::Barcodes TakeInvalidResults(ZXing::Barcodes &results)
+{
+    auto it = std::stable_partition(results.begin(), results.end(), [](const ZXing::Barcode &b) { return b.isValid(); });
+    ZXing::Barcodes invalid(std::make_move_iterator(it), std::make_move_iterator(results.end()));
+    results.erase(it, results.end());
+    return invalid;
+}
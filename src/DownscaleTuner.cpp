@@ -0,0 +1,77 @@
+#include "DownscaleTuner.h"
+#include <QMutexLocker>
+#include <algorithm>
+
+void DownscaleTuner::record(int codeSize)
+{
+    if (codeSize <= 0)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    m_sizes[m_next] = codeSize;
+    m_next = (m_next + 1) % History;
+    m_count = qMin(m_count + 1, History);
+}
+
+void DownscaleTuner::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_sizes = {};
+    m_count = 0;
+    m_next = 0;
+    m_current = {};
+}
+
+DownscaleTuner::Profile DownscaleTuner::profile(int width, int height, const Profile &fallback)
+{
+    QMutexLocker locker(&m_mutex);
+    int size = codeSizeLocked();
+    if (size <= 0)
+    {
+        m_current = fallback;
+        return fallback;
+    }
+
+    Profile profile;
+    int side = qMin(width, height);
+    // 缩小一半后条码已无法识别，缩小的各层只会浪费时间
+    int factor = qMin(size / MinCodeSize, MaxFactor);
+    if (factor < 2 || side / factor < MinCodeSize)
+    {
+        profile.enabled = false;
+        profile.threshold = fallback.threshold;
+        profile.factor = fallback.factor;
+    }
+    else
+    {
+        // ZXing在图像长边超过阈值时继续缩小，阈值略大于缩小一次后的长边，只生成一层缩小图像
+        profile.factor = factor;
+        profile.threshold = qMin(qMax(width, height) / factor + 1, 0xFFFF);
+    }
+    m_current = profile;
+    return profile;
+}
+
+int DownscaleTuner::codeSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return codeSizeLocked();
+}
+
+DownscaleTuner::Profile DownscaleTuner::current() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_current;
+}
+
+int DownscaleTuner::codeSizeLocked() const
+{
+    if (m_count < MinSamples)
+        return 0;
+
+    // 取较小的条码尺寸(20%分位)，避免偶尔出现的小码被缩小后漏识别
+    std::array<int, History> sizes = m_sizes;
+    auto nth = sizes.begin() + m_count / 5;
+    std::nth_element(sizes.begin(), nth, sizes.begin() + m_count);
+    return *nth;
+}
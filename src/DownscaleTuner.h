@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QMutex>
+#include <array>
+
+// 缩小识别参数自动调整
+// 记录相机近期识别到的条码尺寸，根据帧尺寸与典型条码尺寸选择ZXing的缩小阈值与倍数：
+// 条码较小时缩小后无法识别，不再缩小；条码较大时只保留一层缩小到条码仍可识别的最大倍数
+class DownscaleTuner
+{
+public:
+    struct Profile
+    {
+        bool enabled = true;    // 是否缩小识别
+        int threshold = 500;    // 图像长边超过该值时缩小(px)
+        int factor = 3;         // 每层缩小倍数
+    };
+
+    DownscaleTuner() = default;
+
+    // 记录识别到的条码尺寸(px)，为条码外接矩形的短边
+    void record(int codeSize);
+    void reset();
+
+    // 返回width x height的帧使用的参数，样本不足时返回fallback
+    Profile profile(int width, int height, const Profile &fallback);
+    // 近期条码的典型尺寸(px)，样本不足时为0
+    int codeSize() const;
+    // 最近一次选择的参数
+    Profile current() const;
+
+private:
+    int codeSizeLocked() const;
+
+    // 保留的近期条码数
+    static constexpr int History = 32;
+    // 样本少于该值时使用手动参数
+    static constexpr int MinSamples = 5;
+    // 缩小后条码短边不小于该值时仍可识别(px)
+    static constexpr int MinCodeSize = 60;
+    // ZXing支持的最大缩小倍数中实际使用的上限
+    static constexpr int MaxFactor = 4;
+
+    mutable QMutex m_mutex;
+    std::array<int, History> m_sizes = {};
+    int m_count = 0;
+    int m_next = 0;
+    Profile m_current;
+};
@@ -0,0 +1,65 @@
+#include "DuplicateFilter.h"
+#include <QMutexLocker>
+
+DuplicateFilter::DuplicateFilter()
+{
+    m_clock.start();
+}
+
+void DuplicateFilter::setWindow(int ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_window = qMax(0, ms);
+}
+
+int DuplicateFilter::window() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_window;
+}
+
+bool DuplicateFilter::accept(const QString &text, int format)
+{
+    QMutexLocker locker(&m_mutex);
+    // 窗口为0时不抑制，也不记录
+    if (m_window == 0)
+    {
+        m_seen.clear();
+        return true;
+    }
+
+    auto now = m_clock.elapsed();
+    // 每隔一个窗口清除一次过期记录，使内存占用有界
+    if (now - m_lastExpire > m_window)
+        expireLocked(now);
+
+    auto key = qMakePair(format, text);
+    auto it = m_seen.find(key);
+    if (it == m_seen.end())
+    {
+        m_seen.insert(key, now);
+        return true;
+    }
+
+    bool fresh = now - it.value() > m_window;
+    it.value() = now;
+    return fresh;
+}
+
+void DuplicateFilter::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_seen.clear();
+}
+
+void DuplicateFilter::expireLocked(qint64 now)
+{
+    for (auto it = m_seen.begin(); it != m_seen.end();)
+    {
+        if (now - it.value() > m_window)
+            it = m_seen.erase(it);
+        else
+            ++it;
+    }
+    m_lastExpire = now;
+}
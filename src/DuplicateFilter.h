@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+// 连续扫描时的重复结果抑制
+// 相同内容与格式的条码在时间窗口内再次出现时被抑制，每次出现都会刷新其时间，超过窗口未出现的记录被清除
+class DuplicateFilter
+{
+public:
+    DuplicateFilter();
+
+    // 时间窗口(ms)，0表示不抑制
+    void setWindow(int ms);
+    int window() const;
+
+    // 判断条码是否为新结果，可在任意线程调用
+    bool accept(const QString &text, int format);
+    void clear();
+
+private:
+    void expireLocked(qint64 now);
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    QHash<QPair<int, QString>, qint64> m_seen;  // 条码最后出现的时间
+    qint64 m_lastExpire = 0;
+    int m_window = 3000;
+};
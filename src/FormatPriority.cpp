@@ -0,0 +1,86 @@
+#include "FormatPriority.h"
+#include <QMutexLocker>
+#include <algorithm>
+
+ZXing::BarcodeFormats FormatPriority::formats(ZXing::BarcodeFormats allowed)
+{
+    QMutexLocker locker(&m_mutex);
+    m_frames++;
+
+    // 只统计用户允许的格式，未指定格式时允许全部格式
+    auto candidates = allowed.empty() ? ZXing::BarcodeFormats(ZXing::BarcodeFormat::Any) : allowed;
+    QList<QPair<ZXing::BarcodeFormat, quint64>> counts;
+    quint64 total = 0;
+    for (auto &[format, count] : m_counts)
+    {
+        if (candidates.testFlag(format))
+        {
+            counts.append({ format, count });
+            total += count;
+        }
+    }
+
+    if (total < MinSamples || m_frames % FullInterval == 0)
+    {
+        m_fullPasses++;
+        return allowed;
+    }
+
+    std::sort(counts.begin(), counts.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+
+    // 取累计占比达到要求的最常见格式
+    ZXing::BarcodeFormats formats;
+    quint64 covered = 0;
+    for (int i = 0; i < counts.size() && i < MaxFormats && covered < Coverage * total; i++)
+    {
+        formats |= counts[i].first;
+        covered += counts[i].second;
+    }
+
+    m_priorityPasses++;
+    return formats;
+}
+
+void FormatPriority::record(ZXing::BarcodeFormat format)
+{
+    QMutexLocker locker(&m_mutex);
+    if (++m_counts[format] > MaxCount)
+    {
+        for (auto &entry : m_counts)
+            entry.second /= 2;
+    }
+}
+
+void FormatPriority::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_counts.clear();
+    m_frames = 0;
+    m_fullPasses = 0;
+    m_priorityPasses = 0;
+}
+
+QList<QPair<ZXing::BarcodeFormat, quint64>> FormatPriority::histogram() const
+{
+    QMutexLocker locker(&m_mutex);
+    QList<QPair<ZXing::BarcodeFormat, quint64>> counts;
+    for (auto &[format, count] : m_counts)
+    {
+        if (count > 0)
+            counts.append({ format, count });
+    }
+    std::sort(counts.begin(), counts.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+    return counts;
+}
+
+quint64 FormatPriority::fullPasses() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_fullPasses;
+}
+
+quint64 FormatPriority::priorityPasses() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_priorityPasses;
+}
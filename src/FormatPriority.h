@@ -0,0 +1,45 @@
+#pragma once
+
+#include <ZXing/BarcodeFormat.h>
+#include <QMutex>
+#include <QList>
+#include <QPair>
+#include <map>
+
+// 条码格式优先级
+// 统计本次运行中识别到的各条码格式次数，优先只识别最常见的格式；
+// 每隔若干帧进行一次全格式识别，以便发现新出现的格式
+class FormatPriority
+{
+public:
+    FormatPriority() = default;
+
+    // 返回本帧优先识别的格式，allowed为用户允许的格式；样本不足或轮到全格式识别时返回allowed
+    ZXing::BarcodeFormats formats(ZXing::BarcodeFormats allowed);
+    // 记录识别到的格式
+    void record(ZXing::BarcodeFormat format);
+    void reset();
+
+    // 按次数由多到少排列的格式与次数
+    QList<QPair<ZXing::BarcodeFormat, quint64>> histogram() const;
+    quint64 fullPasses() const;
+    quint64 priorityPasses() const;
+
+private:
+    // 样本少于该值时不做限制
+    static constexpr quint64 MinSamples = 5;
+    // 单个格式次数超过该值时全部减半，使统计跟随近期变化
+    static constexpr quint64 MaxCount = 1000;
+    // 最多优先识别的格式数
+    static constexpr int MaxFormats = 3;
+    // 全格式识别间隔(帧)
+    static constexpr quint64 FullInterval = 10;
+    // 常见格式累计占比达到该值即可，其余格式不再优先识别
+    static constexpr double Coverage = 0.95;
+
+    mutable QMutex m_mutex;
+    std::map<ZXing::BarcodeFormat, quint64> m_counts;
+    quint64 m_frames = 0;
+    quint64 m_fullPasses = 0;
+    quint64 m_priorityPasses = 0;
+};
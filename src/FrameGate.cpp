@@ -0,0 +1,156 @@
+#include "FrameGate.h"
+#include <QMutexLocker>
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRAMEGATE_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define FRAMEGATE_NEON
+#endif
+
+using ZXing::ImageFormat;
+
+// 每格采样的行数与每行采样的像素数
+static constexpr int kSampleRows = 4;
+static constexpr int kSampleCols = 16;
+
+// 连续16个灰度像素求和
+static inline unsigned Sum16(const uint8_t *p)
+{
+#if defined(FRAMEGATE_SSE2)
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i s = _mm_sad_epu8(v, _mm_setzero_si128());
+    return static_cast<unsigned>(_mm_cvtsi128_si32(s) + _mm_extract_epi16(s, 4));
+#elif defined(FRAMEGATE_NEON)
+    return vaddlvq_u8(vld1q_u8(p));
+#else
+    unsigned sum = 0;
+    for (int i = 0; i < 16; i++)
+        sum += p[i];
+    return sum;
+#endif
+}
+
+void FrameGate::signature(const ZXing::ImageView &image, Signature &sig)
+{
+    const int w = image.width();
+    const int h = image.height();
+    const int ps = image.pixStride();
+    const auto fmt = image.format();
+    const bool lum = fmt == ImageFormat::Lum || fmt == ImageFormat::LumA;
+    const int r = ZXing::RedIndex(fmt), g = ZXing::GreenIndex(fmt), b = ZXing::BlueIndex(fmt);
+
+    for (int cy = 0; cy < GridHeight; cy++)
+    {
+        const int y0 = cy * h / GridHeight;
+        const int ch = std::max(1, (cy + 1) * h / GridHeight - y0);
+        for (int cx = 0; cx < GridWidth; cx++)
+        {
+            const int x0 = cx * w / GridWidth;
+            const int cw = std::max(1, (cx + 1) * w / GridWidth - x0);
+            const int cols = std::min(kSampleCols, cw);
+            unsigned sum = 0;
+            int count = 0;
+            for (int i = 0; i < kSampleRows; i++)
+            {
+                const int y = std::min(h - 1, y0 + (2 * i + 1) * ch / (2 * kSampleRows));
+                const uint8_t *p = image.data(x0, y);
+                // 连续存储的灰度行使用向量求和
+                if (lum && ps == 1 && cols == kSampleCols)
+                {
+                    sum += Sum16(p);
+                }
+                else if (lum)
+                {
+                    for (int x = 0; x < cols; x++)
+                        sum += p[x * ps];
+                }
+                else
+                {
+                    for (int x = 0; x < cols; x++)
+                    {
+                        const uint8_t *px = p + x * ps;
+                        sum += ZXing::RGBToLum(px[r], px[g], px[b]);
+                    }
+                }
+                count += cols;
+            }
+            sig[cy * GridWidth + cx] = static_cast<uint8_t>(sum / count);
+        }
+    }
+}
+
+int FrameGate::difference(const Signature &a, const Signature &b)
+{
+    static_assert(sizeof(Signature) % 16 == 0, "signature size must be a multiple of 16");
+#if defined(FRAMEGATE_SSE2)
+    __m128i acc = _mm_setzero_si128();
+    for (size_t i = 0; i < a.size(); i += 16)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a.data() + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b.data() + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    return _mm_cvtsi128_si32(acc) + _mm_extract_epi16(acc, 4) + (_mm_extract_epi16(acc, 5) << 16);
+#elif defined(FRAMEGATE_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (size_t i = 0; i < a.size(); i += 16)
+    {
+        uint8x16_t d = vabdq_u8(vld1q_u8(a.data() + i), vld1q_u8(b.data() + i));
+        acc = vpadalq_u16(acc, vpaddlq_u8(d));
+    }
+    return static_cast<int>(vaddvq_u32(acc));
+#else
+    int sum = 0;
+    for (size_t i = 0; i < a.size(); i++)
+        sum += std::abs(a[i] - b[i]);
+    return sum;
+#endif
+}
+
+bool FrameGate::skip(const ZXing::ImageView &image)
+{
+    Signature sig;
+    signature(image, sig);
+
+    QMutexLocker locker(&m_mutex);
+    if (m_hasReference && m_skipCount < MaxSkip
+        && difference(sig, m_reference) < Threshold * static_cast<int>(sig.size()))
+    {
+        m_skipCount++;
+        m_skipped++;
+        return true;
+    }
+
+    m_skipCount = 0;
+    m_candidate = sig;
+    m_hasCandidate = true;
+    return false;
+}
+
+void FrameGate::update(bool found)
+{
+    QMutexLocker locker(&m_mutex);
+    // 识别到结果时不设参考，保证条码在画面中时每帧都识别
+    m_hasReference = !found && m_hasCandidate;
+    if (m_hasReference)
+        m_reference = m_candidate;
+    m_hasCandidate = false;
+}
+
+void FrameGate::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_hasReference = false;
+    m_hasCandidate = false;
+    m_skipCount = 0;
+}
+
+quint64 FrameGate::skipped() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_skipped;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <ZXing/ImageView.h>
+#include <QMutex>
+#include <array>
+#include <cstdint>
+
+// 画面变化门限
+// 计算帧的低分辨率亮度签名，与上一次未识别到结果的帧比较，画面基本不变时跳过识别
+class FrameGate
+{
+public:
+    static constexpr int GridWidth = 32;
+    static constexpr int GridHeight = 24;
+    using Signature = std::array<uint8_t, GridWidth * GridHeight>;
+    // 平均每格亮度差低于该值时认为画面未变化
+    static constexpr int Threshold = 2;
+    // 连续跳过的最大帧数，超过后强制识别一次
+    static constexpr int MaxSkip = 50;
+
+    FrameGate() = default;
+
+    // 判断是否跳过本帧，不跳过时本帧签名作为候选参考
+    bool skip(const ZXing::ImageView &image);
+    // 记录本帧识别结果，未识别到时将候选签名作为参考
+    void update(bool found);
+    void reset();
+
+    quint64 skipped() const;    // 累计跳过的帧数
+
+    // 计算亮度签名
+    static void signature(const ZXing::ImageView &image, Signature &sig);
+    // 两个签名的亮度差绝对值之和
+    static int difference(const Signature &a, const Signature &b);
+
+private:
+    mutable QMutex m_mutex;
+    Signature m_reference = {};     // 上一次未识别到结果的帧签名
+    Signature m_candidate = {};     // 最近一次识别的帧签名
+    bool m_hasReference = false;
+    bool m_hasCandidate = false;
+    int m_skipCount = 0;
+    quint64 m_skipped = 0;
+};
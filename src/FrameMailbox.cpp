@@ -0,0 +1,83 @@
+#include "FrameMailbox.h"
+#include <QMutexLocker>
+
+FrameMailbox::FrameMailbox(int capacity, int maxInFlight)
+    : m_capacity(qMax(1, capacity))
+    , m_maxInFlight(qMax(1, maxInFlight))
+{
+}
+
+void FrameMailbox::post(ScanFrame &&frame)
+{
+    QMutexLocker locker(&m_mutex);
+    while (static_cast<int>(m_frames.size()) >= m_capacity)
+    {
+        m_frames.pop_front();
+        m_dropped++;
+    }
+    m_frames.push_back(std::move(frame));
+}
+
+bool FrameMailbox::take(ScanFrame &frame)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_frames.empty() || m_inFlight >= m_maxInFlight)
+        return false;
+
+    frame = std::move(m_frames.front());
+    m_frames.pop_front();
+    m_inFlight++;
+    return true;
+}
+
+void FrameMailbox::done()
+{
+    QMutexLocker locker(&m_mutex);
+    m_inFlight--;
+}
+
+void FrameMailbox::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_frames.clear();
+}
+
+bool FrameMailbox::complete(qint64 captured)
+{
+    QMutexLocker locker(&m_mutex);
+    m_processed++;
+    if (captured < m_newest)
+        return false;
+    m_newest = captured;
+    return true;
+}
+
+void FrameMailbox::abandon()
+{
+    QMutexLocker locker(&m_mutex);
+    m_abandoned++;
+}
+
+int FrameMailbox::inFlight() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_inFlight;
+}
+
+quint64 FrameMailbox::dropped() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_dropped;
+}
+
+quint64 FrameMailbox::processed() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_processed;
+}
+
+quint64 FrameMailbox::abandoned() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_abandoned;
+}
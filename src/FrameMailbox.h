@@ -0,0 +1,68 @@
+#pragma once
+
+#include <ZXing/ImageView.h>
+#include <QDeadlineTimer>
+#include <QImage>
+#include <QVideoFrame>
+#include <QMutex>
+#include <deque>
+#include <memory>
+
+// 待识别的帧：相机捕获的静态图像、视频流帧或采集后端的灰度帧
+struct ScanFrame
+{
+    int id = 0;
+    QImage image;
+    QVideoFrame frame;
+    bool file = false;  // 是否来自图片文件
+    qint64 captured = 0;    // 采集时间(ms)，与QDeadlineTimer使用相同的单调时钟
+    QDeadlineTimer deadline { QDeadlineTimer::Forever };    // 识别截止时间
+    std::shared_ptr<const ZXing::ImageView> raw;    // 采集后端直接提供的灰度帧，引用全部释放时归还缓冲区
+
+    // 记录采集时间并设置截止时间，ms不大于0时不限制
+    void stamp(int ms)
+    {
+        captured = QDeadlineTimer::current().deadline();
+        deadline = ms > 0 ? QDeadlineTimer(ms) : QDeadlineTimer(QDeadlineTimer::Forever);
+    }
+};
+
+// 采集与识别之间的有界信箱
+// 队列满时丢弃最旧的帧，并限制同时识别的帧数，使识别始终处理最新的帧且内存占用恒定
+class FrameMailbox
+{
+public:
+    explicit FrameMailbox(int capacity = 1, int maxInFlight = 1);
+
+    // 投递新帧，队列已满时丢弃最旧的帧
+    void post(ScanFrame &&frame);
+    // 取出待识别的帧，队列为空或达到并发上限时返回false
+    bool take(ScanFrame &frame);
+    // 一帧识别完成，必须与成功的take()成对调用
+    void done();
+    // 清空未处理的帧
+    void clear();
+    // 记录完成识别的帧，比已完成的最新帧更旧时返回false，其结果应丢弃；
+    // 超时放弃、门限跳过等未实际识别的帧不调用
+    bool complete(qint64 captured);
+    // 放弃超过截止时间或已过期的帧
+    void abandon();
+
+    int capacity() const { return m_capacity; }
+    int maxInFlight() const { return m_maxInFlight; }
+    int inFlight() const;
+    quint64 dropped() const;    // 丢弃的帧数
+    quint64 processed() const;  // 实际完成识别的帧数，不含丢弃、放弃与跳过的帧
+    quint64 abandoned() const;  // 超时或过期而放弃的帧数
+
+private:
+    mutable QMutex m_mutex;
+    std::deque<ScanFrame> m_frames;
+    int m_capacity = 1;
+    int m_maxInFlight = 1;
+    int m_inFlight = 0;
+    quint64 m_dropped = 0;
+    quint64 m_processed = 0;
+    quint64 m_abandoned = 0;
+    qint64 m_newest = 0;    // 已完成的最新帧的采集时间
+};
@@ -0,0 +1,175 @@
+#include "FrameView.h"
+#include "FrameMailbox.h"
+#include "LumaConverter.h"
+#include <QDebug>
+#include <cstring>
+
+using ZXing::ImageFormat;
+
+FrameView::FrameView(const ScanFrame &frame)
+{
+    if (frame.raw)
+        m_view = *frame.raw;
+    else if (frame.frame.isValid())
+        mapVideoFrame(frame.frame);
+    else if (!frame.image.isNull())
+        mapImage(frame.image);
+}
+
+FrameView::~FrameView()
+{
+    if (m_mapped)
+        m_frame.unmap();
+}
+
+void FrameView::mapImage(const QImage &img)
+{
+    auto fmt = ImageFormat::None;
+    switch (img.format())
+    {
+    case QImage::Format_ARGB32:
+    case QImage::Format_RGB32:
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        fmt = ImageFormat::BGRA;
+#else
+        fmt = ImageFormat::ARGB;
+#endif
+        break;
+    case QImage::Format_RGB888: fmt = ImageFormat::RGB; break;
+    case QImage::Format_RGBX8888:
+    case QImage::Format_RGBA8888: fmt = ImageFormat::RGBA; break;
+    case QImage::Format_Grayscale8: fmt = ImageFormat::Lum; break;
+    default: break;
+    }
+
+    if (fmt == ImageFormat::None && LumaConverter::supports(img.format()))
+    {
+        // 常见的不支持格式直接提取灰度，内存从线程的缓冲池借用
+        m_buffer = BufferPool::local().acquire(static_cast<size_t>(img.width()) * img.height());
+        m_view = LumaConverter::convert(img, m_buffer.storage());
+        return;
+    }
+
+    if (fmt == ImageFormat::None)
+    {
+        // 其余格式由Qt转换为灰度图像
+        m_image = img.convertToFormat(QImage::Format_Grayscale8);
+        fmt = ImageFormat::Lum;
+    }
+    else
+    {
+        m_image = img;
+    }
+
+    // 使用constBits()避免共享图像数据被分离复制
+    m_view = { m_image.constBits(), m_image.width(), m_image.height(), fmt, static_cast<int>(m_image.bytesPerLine()) };
+}
+
+void FrameView::mapVideoFrame(const QVideoFrame &frame)
+{
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    // Qt5不使用视频流模式，直接转换为图像
+    mapImage(frame.image());
+#else
+    auto fmt = ImageFormat::None;
+    int pixStride = 0;
+    int pixOffset = 0;
+
+    // 与ZXingQtReader.h中的格式对应关系一致，YUV格式只取Y分量
+    switch (frame.pixelFormat())
+    {
+    case QVideoFrameFormat::Format_ARGB8888:
+    case QVideoFrameFormat::Format_ARGB8888_Premultiplied:
+    case QVideoFrameFormat::Format_RGBX8888:
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        fmt = ImageFormat::BGRA;
+#else
+        fmt = ImageFormat::ARGB;
+#endif
+        break;
+
+    case QVideoFrameFormat::Format_BGRA8888:
+    case QVideoFrameFormat::Format_BGRA8888_Premultiplied:
+    case QVideoFrameFormat::Format_BGRX8888:
+    case QVideoFrameFormat::Format_ABGR8888:
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        fmt = ImageFormat::RGBA;
+#else
+        fmt = ImageFormat::ABGR;
+#endif
+        break;
+
+    case QVideoFrameFormat::Format_P010:
+    case QVideoFrameFormat::Format_P016: fmt = ImageFormat::Lum, pixStride = 1; break;
+
+    case QVideoFrameFormat::Format_AYUV:
+    case QVideoFrameFormat::Format_AYUV_Premultiplied:
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        fmt = ImageFormat::Lum, pixStride = 4, pixOffset = 3;
+#else
+        fmt = ImageFormat::Lum, pixStride = 4, pixOffset = 2;
+#endif
+        break;
+
+    case QVideoFrameFormat::Format_YUV420P:
+    case QVideoFrameFormat::Format_YUV422P:
+    case QVideoFrameFormat::Format_NV12:
+    case QVideoFrameFormat::Format_NV21:
+    case QVideoFrameFormat::Format_IMC1:
+    case QVideoFrameFormat::Format_IMC2:
+    case QVideoFrameFormat::Format_IMC3:
+    case QVideoFrameFormat::Format_IMC4:
+    case QVideoFrameFormat::Format_YV12:
+    case QVideoFrameFormat::Format_Y8: fmt = ImageFormat::Lum; break;
+    case QVideoFrameFormat::Format_UYVY: fmt = ImageFormat::Lum, pixStride = 2, pixOffset = 1; break;
+    case QVideoFrameFormat::Format_YUYV: fmt = ImageFormat::Lum, pixStride = 2; break;
+    case QVideoFrameFormat::Format_Y16: fmt = ImageFormat::Lum, pixStride = 2, pixOffset = 1; break;
+    default: break;
+    }
+
+    if (fmt == ImageFormat::None)
+    {
+        mapImage(frame.toImage());
+        return;
+    }
+
+    m_frame = frame;
+    if (!m_frame.map(QVideoFrame::ReadOnly))
+    {
+        qWarning() << "invalid QVideoFrame: could not map memory";
+        return;
+    }
+    m_mapped = true;
+    m_view = { m_frame.bits(0) + pixOffset, m_frame.width(), m_frame.height(), fmt, m_frame.bytesPerLine(0), pixStride };
+#endif
+}
+
+QImage FrameView::toImage(const ZXing::ImageView &view)
+{
+    const int ps = view.pixStride();
+    const auto fmt = view.format();
+    const bool lum = fmt == ImageFormat::Lum || fmt == ImageFormat::LumA;
+    const int r = ZXing::RedIndex(fmt), g = ZXing::GreenIndex(fmt), b = ZXing::BlueIndex(fmt);
+
+    QImage img(view.width(), view.height(), QImage::Format_Grayscale8);
+    for (int y = 0; y < view.height(); y++)
+    {
+        const uint8_t *src = view.data(0, y);
+        uchar *dst = img.scanLine(y);
+        if (lum && ps == 1)
+        {
+            std::memcpy(dst, src, view.width());
+        }
+        else if (lum)
+        {
+            for (int x = 0; x < view.width(); x++)
+                dst[x] = src[x * ps];
+        }
+        else
+        {
+            for (int x = 0; x < view.width(); x++, src += ps)
+                dst[x] = ZXing::RGBToLum(src[r], src[g], src[b]);
+        }
+    }
+    return img;
+}
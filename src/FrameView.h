@@ -0,0 +1,39 @@
+#pragma once
+
+#include <ZXing/ImageView.h>
+#include "BufferPool.h"
+#include <QImage>
+#include <QVideoFrame>
+
+struct ScanFrame;
+
+// 将待识别的帧映射为ZXing::ImageView
+// 支持的像素格式与采集后端的帧直接引用帧内存不复制，视频帧在对象生命周期内保持映射；
+// 其他格式提取为灰度图像
+class FrameView
+{
+public:
+    explicit FrameView(const ScanFrame &frame);
+    ~FrameView();
+
+    FrameView(const FrameView &) = delete;
+    FrameView &operator=(const FrameView &) = delete;
+
+    bool isValid() const { return m_view.data() != nullptr; }
+    const ZXing::ImageView &view() const { return m_view; }
+    int width() const { return m_view.width(); }
+    int height() const { return m_view.height(); }
+
+    // 将图像视图复制为灰度QImage，用于预览与标记
+    static QImage toImage(const ZXing::ImageView &view);
+
+private:
+    void mapImage(const QImage &img);
+    void mapVideoFrame(const QVideoFrame &frame);
+
+    QImage m_image;         // 引用的图像，或转换后的灰度图像
+    QVideoFrame m_frame;    // 已映射的视频帧
+    BufferPool::Buffer m_buffer;    // 提取的灰度图像内存
+    bool m_mapped = false;
+    ZXing::ImageView m_view;
+};
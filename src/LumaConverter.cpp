@@ -0,0 +1,337 @@
+#include "LumaConverter.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LUMA_SSE2
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LUMA_AVX2
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define LUMA_NEON
+#endif
+
+using ZXing::ImageFormat;
+
+namespace {
+
+// 亮度权重与ZXing::RGBToLum相同，和为1024：Y = (306R + 601G + 117B + 512) >> 10，
+// 转换后的灰度与ZXing直接识别彩色图像时一致
+constexpr int WeightR = 306;
+constexpr int WeightG = 601;
+constexpr int WeightB = 117;
+constexpr int Rounding = 512;
+
+inline uint8_t Luma(unsigned r, unsigned g, unsigned b)
+{
+    return ZXing::RGBToLum(r, g, b);
+}
+
+// 32位像素中各8位分量所在的位置（相对于最低位的右移位数），a为预乘透明度的位置，无透明度时为-1
+struct Shifts
+{
+    int r, g, b;
+    int a = -1;
+};
+
+// 透明度分量的掩码，无透明度时为0，与任意像素比较都视为不透明
+inline uint32_t AlphaMask(Shifts s)
+{
+    return s.a < 0 ? 0 : 0xFFu << s.a;
+}
+
+// 单个32位像素的亮度，预乘透明度的像素先还原分量
+inline uint8_t Luma32(uint32_t p, Shifts s)
+{
+    unsigned r = (p >> s.r) & 0xFF, g = (p >> s.g) & 0xFF, b = (p >> s.b) & 0xFF;
+    if (s.a < 0)
+        return Luma(r, g, b);
+    QRgb c = qUnpremultiply(qRgba(r, g, b, (p >> s.a) & 0xFF));
+    return Luma(qRed(c), qGreen(c), qBlue(c));
+}
+
+#if defined(LUMA_SSE2)
+// 8个像素的16位分量计算亮度，加权和超出16位，R、G与B、1分别交错后按32位乘加
+inline __m128i Luma16(__m128i r, __m128i g, __m128i b)
+{
+    const __m128i wrg = _mm_set1_epi32(WeightG << 16 | WeightR);
+    const __m128i wb = _mm_set1_epi32(Rounding << 16 | WeightB);
+    const __m128i one = _mm_set1_epi16(1);
+    __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(r, g), wrg), _mm_madd_epi16(_mm_unpacklo_epi16(b, one), wb));
+    __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(r, g), wrg), _mm_madd_epi16(_mm_unpackhi_epi16(b, one), wb));
+    return _mm_packs_epi32(_mm_srli_epi32(lo, 10), _mm_srli_epi32(hi, 10));
+}
+
+// 取出4个32位像素中的一个8位分量，结果为32位
+inline __m128i Channel32(__m128i v, __m128i shift)
+{
+    return _mm_and_si128(_mm_srl_epi32(v, shift), _mm_set1_epi32(0xFF));
+}
+#endif
+
+#if defined(LUMA_AVX2)
+inline __m256i Luma16(__m256i r, __m256i g, __m256i b)
+{
+    const __m256i wrg = _mm256_set1_epi32(WeightG << 16 | WeightR);
+    const __m256i wb = _mm256_set1_epi32(Rounding << 16 | WeightB);
+    const __m256i one = _mm256_set1_epi16(1);
+    __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(r, g), wrg), _mm256_madd_epi16(_mm256_unpacklo_epi16(b, one), wb));
+    __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(r, g), wrg), _mm256_madd_epi16(_mm256_unpackhi_epi16(b, one), wb));
+    return _mm256_packs_epi32(_mm256_srli_epi32(lo, 10), _mm256_srli_epi32(hi, 10));
+}
+
+inline __m256i Channel32(__m256i v, __m128i shift)
+{
+    return _mm256_and_si256(_mm256_srl_epi32(v, shift), _mm256_set1_epi32(0xFF));
+}
+
+// 16个32位像素计算为16位亮度，顺序为每128位通道内两组交错，由调用方统一重排
+inline __m256i Luma32x16(__m256i a, __m256i b, __m128i sr, __m128i sg, __m128i sb)
+{
+    return Luma16(_mm256_packs_epi32(Channel32(a, sr), Channel32(b, sr)),
+        _mm256_packs_epi32(Channel32(a, sg), Channel32(b, sg)),
+        _mm256_packs_epi32(Channel32(a, sb), Channel32(b, sb)));
+}
+#endif
+
+#if defined(LUMA_NEON)
+// 8个像素的16位分量计算亮度，按32位乘加后舍入
+inline uint8x8_t Luma16(uint16x8_t r, uint16x8_t g, uint16x8_t b)
+{
+    uint32x4_t lo = vmull_n_u16(vget_low_u16(r), WeightR);
+    lo = vmlal_n_u16(lo, vget_low_u16(g), WeightG);
+    lo = vmlal_n_u16(lo, vget_low_u16(b), WeightB);
+    uint32x4_t hi = vmull_n_u16(vget_high_u16(r), WeightR);
+    hi = vmlal_n_u16(hi, vget_high_u16(g), WeightG);
+    hi = vmlal_n_u16(hi, vget_high_u16(b), WeightB);
+    return vmovn_u16(vcombine_u16(vrshrn_n_u32(lo, 10), vrshrn_n_u32(hi, 10)));
+}
+#endif
+
+// 预乘透明度的像素块中有不透明度不为255的像素时逐个还原分量，返回块后的位置
+inline int Translucent32(const uint32_t *src, uint8_t *dst, int x, int count, Shifts s)
+{
+    for (int end = x + count; x < end; x++)
+        dst[x] = Luma32(src[x], s);
+    return x;
+}
+
+// 一行32位像素，返回已处理的像素数；预乘透明度的格式中完全不透明的像素块与普通格式相同，直接向量计算
+int Row32(const uint32_t *src, uint8_t *dst, int width, Shifts s)
+{
+    int x = 0;
+#if defined(LUMA_AVX2)
+    {
+        const __m128i sr = _mm_cvtsi32_si128(s.r), sg = _mm_cvtsi32_si128(s.g), sb = _mm_cvtsi32_si128(s.b);
+        const __m256i alpha = _mm256_set1_epi32(static_cast<int>(AlphaMask(s)));
+        // 通道内打包后的32位单元顺序为 A0 B0 C0 D0 | A1 B1 C1 D1，重排为 A0 A1 B0 B1 ...
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        while (x + 32 <= width)
+        {
+            __m256i p[4];
+            for (int i = 0; i < 4; i++)
+                p[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x + i * 8));
+            __m256i all = _mm256_and_si256(_mm256_and_si256(p[0], p[1]), _mm256_and_si256(p[2], p[3]));
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(all, alpha), alpha)) != -1)
+            {
+                x = Translucent32(src, dst, x, 32, s);
+                continue;
+            }
+            __m256i lo = Luma32x16(p[0], p[1], sr, sg, sb);
+            __m256i hi = Luma32x16(p[2], p[3], sr, sg, sb);
+            __m256i y = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(lo, hi), order);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), y);
+            x += 32;
+        }
+    }
+#endif
+#if defined(LUMA_SSE2)
+    const __m128i sr = _mm_cvtsi32_si128(s.r), sg = _mm_cvtsi32_si128(s.g), sb = _mm_cvtsi32_si128(s.b);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(AlphaMask(s)));
+    while (x + 16 <= width)
+    {
+        __m128i p[4];
+        for (int i = 0; i < 4; i++)
+            p[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x + i * 4));
+        __m128i all = _mm_and_si128(_mm_and_si128(p[0], p[1]), _mm_and_si128(p[2], p[3]));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(all, alpha), alpha)) != 0xFFFF)
+        {
+            x = Translucent32(src, dst, x, 16, s);
+            continue;
+        }
+        __m128i y[2];
+        for (int half = 0; half < 2; half++)
+        {
+            __m128i a = p[half * 2];
+            __m128i b = p[half * 2 + 1];
+            y[half] = Luma16(_mm_packs_epi32(Channel32(a, sr), Channel32(b, sr)),
+                _mm_packs_epi32(Channel32(a, sg), Channel32(b, sg)),
+                _mm_packs_epi32(Channel32(a, sb), Channel32(b, sb)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(y[0], y[1]));
+        x += 16;
+    }
+#elif defined(LUMA_NEON)
+    const int32x4_t sr = vdupq_n_s32(-s.r), sg = vdupq_n_s32(-s.g), sb = vdupq_n_s32(-s.b);
+    const uint32x4_t mask = vdupq_n_u32(0xFF);
+    const uint32x4_t alpha = vdupq_n_u32(AlphaMask(s));
+    for (; x + 8 <= width; x += 8)
+    {
+        uint32x4_t a = vld1q_u32(src + x);
+        uint32x4_t b = vld1q_u32(src + x + 4);
+        if (vminvq_u32(vceqq_u32(vandq_u32(vandq_u32(a, b), alpha), alpha)) == 0)
+        {
+            Translucent32(src, dst, x, 8, s);
+            continue;
+        }
+        auto channel = [&](int32x4_t shift) {
+            return vcombine_u16(vmovn_u32(vandq_u32(vshlq_u32(a, shift), mask)), vmovn_u32(vandq_u32(vshlq_u32(b, shift), mask)));
+            };
+        vst1_u8(dst + x, Luma16(channel(sr), channel(sg), channel(sb)));
+    }
+#endif
+    return x;
+}
+
+// 一行RGB565像素，返回已处理的像素数
+int Row565(const uint16_t *src, uint8_t *dst, int width)
+{
+    int x = 0;
+#if defined(LUMA_SSE2)
+    const __m128i mask5 = _mm_set1_epi16(0x1F), mask6 = _mm_set1_epi16(0x3F);
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i y[2];
+        for (int half = 0; half < 2; half++)
+        {
+            __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x + half * 8));
+            __m128i r = _mm_srli_epi16(p, 11);
+            __m128i g = _mm_and_si128(_mm_srli_epi16(p, 5), mask6);
+            __m128i b = _mm_and_si128(p, mask5);
+            // 扩展到8位：高位复制到低位
+            r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+            g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+            b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+            y[half] = Luma16(r, g, b);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(y[0], y[1]));
+    }
+#elif defined(LUMA_NEON)
+    for (; x + 8 <= width; x += 8)
+    {
+        uint16x8_t p = vld1q_u16(src + x);
+        uint16x8_t r = vshrq_n_u16(p, 11);
+        uint16x8_t g = vandq_u16(vshrq_n_u16(p, 5), vdupq_n_u16(0x3F));
+        uint16x8_t b = vandq_u16(p, vdupq_n_u16(0x1F));
+        r = vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2));
+        g = vorrq_u16(vshlq_n_u16(g, 2), vshrq_n_u16(g, 4));
+        b = vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2));
+        vst1_u8(dst + x, Luma16(r, g, b));
+    }
+#endif
+    return x;
+}
+
+// 一行16位灰度像素取高8位，返回已处理的像素数
+int Row16(const uint16_t *src, uint8_t *dst, int width)
+{
+    int x = 0;
+#if defined(LUMA_SSE2)
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i a = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x)), 8);
+        __m128i b = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x + 8)), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(a, b));
+    }
+#elif defined(LUMA_NEON)
+    for (; x + 8 <= width; x += 8)
+        vst1_u8(dst + x, vshrn_n_u16(vld1q_u16(src + x), 8));
+#endif
+    return x;
+}
+
+// 32位格式各分量的位置，不是32位格式时返回false
+bool Shifts32(QImage::Format format, Shifts &s)
+{
+    switch (format)
+    {
+    case QImage::Format_ARGB32_Premultiplied: s = { 16, 8, 0, 24 }; return true;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    case QImage::Format_RGBA8888_Premultiplied: s = { 0, 8, 16, 24 }; return true;
+#else
+    case QImage::Format_RGBA8888_Premultiplied: s = { 24, 16, 8, 0 }; return true;
+#endif
+    // 10位分量只取高8位
+    case QImage::Format_RGB30: s = { 22, 12, 2 }; return true;
+    case QImage::Format_BGR30: s = { 2, 12, 22 }; return true;
+    default: return false;
+    }
+}
+
+} // namespace
+
+bool LumaConverter::supports(QImage::Format format)
+{
+    Shifts s;
+    return Shifts32(format, s) || format == QImage::Format_RGB16 || format == QImage::Format_Indexed8
+        || format == QImage::Format_Grayscale16;
+}
+
+ZXing::ImageView LumaConverter::convert(const QImage &img, std::vector<uint8_t> &buffer)
+{
+    const auto format = img.format();
+    if (img.isNull() || !supports(format))
+        return {};
+
+    const int w = img.width();
+    const int h = img.height();
+    buffer.resize(static_cast<size_t>(w) * h);
+
+    // 调色板图像先计算各颜色的亮度
+    uint8_t palette[256] = {};
+    if (format == QImage::Format_Indexed8)
+    {
+        auto colors = img.colorTable();
+        int count = qMin(static_cast<int>(colors.size()), 256);
+        for (int i = 0; i < count; i++)
+            palette[i] = Luma(qRed(colors[i]), qGreen(colors[i]), qBlue(colors[i]));
+    }
+
+    Shifts s {};
+    bool is32 = Shifts32(format, s);
+    for (int y = 0; y < h; y++)
+    {
+        const uchar *line = img.constScanLine(y);
+        uint8_t *dst = buffer.data() + static_cast<size_t>(y) * w;
+        int x = 0;
+        if (is32)
+        {
+            auto src = reinterpret_cast<const uint32_t *>(line);
+            for (x = Row32(src, dst, w, s); x < w; x++)
+                dst[x] = Luma32(src[x], s);
+        }
+        else if (format == QImage::Format_RGB16)
+        {
+            auto src = reinterpret_cast<const uint16_t *>(line);
+            for (x = Row565(src, dst, w); x < w; x++)
+            {
+                unsigned r = src[x] >> 11, g = (src[x] >> 5) & 0x3F, b = src[x] & 0x1F;
+                dst[x] = Luma((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2));
+            }
+        }
+        else if (format == QImage::Format_Grayscale16)
+        {
+            auto src = reinterpret_cast<const uint16_t *>(line);
+            for (x = Row16(src, dst, w); x < w; x++)
+                dst[x] = static_cast<uint8_t>(src[x] >> 8);
+        }
+        else
+        {
+            for (; x < w; x++)
+                dst[x] = palette[line[x]];
+        }
+    }
+
+    return { buffer.data(), w, h, ImageFormat::Lum };
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <ZXing/ImageView.h>
+#include <QImage>
+#include <vector>
+
+// 灰度提取
+// 将ZXing不直接支持的QImage像素格式转换为灰度图像，代替通用的QImage::convertToFormat；
+// 32位与16位格式使用SSE2/AVX2/NEON向量运算，输出写入调用方复用的内存
+class LumaConverter
+{
+public:
+    // 是否支持该格式
+    static bool supports(QImage::Format format);
+
+    // 转换为灰度图像，buffer为输出图像内存，不支持的格式返回空视图
+    static ZXing::ImageView convert(const QImage &img, std::vector<uint8_t> &buffer);
+};
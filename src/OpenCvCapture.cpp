@@ -0,0 +1,149 @@
+#include "OpenCvCapture.h"
+#include "FrameView.h"
+#include "ZXingOpenCV.h"
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QStringList>
+#include <QThread>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// 回放时无法获取帧率的文件(如图片序列)使用的帧率
+constexpr double DefaultFps = 10.0;
+
+// 采集使用的帧内存，帧的引用全部释放后复用
+struct Slot
+{
+    cv::Mat mat;
+    std::weak_ptr<const ZXing::ImageView> frame;
+};
+
+} // namespace
+
+OpenCvCapture::OpenCvCapture(QObject *parent)
+    : QObject(parent)
+{
+}
+
+OpenCvCapture::~OpenCvCapture()
+{
+    stop();
+}
+
+bool OpenCvCapture::openCamera(const QString &device, int index, const FrameHandler &handler)
+{
+    auto capture = device.isEmpty() ? std::make_shared<cv::VideoCapture>(index)
+        : std::make_shared<cv::VideoCapture>(device.toStdString());
+    return start(capture, false, handler);
+}
+
+bool OpenCvCapture::openFile(const QString &path, const FrameHandler &handler)
+{
+    // 图片文件作为图片序列打开，其余按视频文件打开
+    static const QStringList imageSuffixes = { "png", "jpg", "jpeg", "bmp", "tif", "tiff", "webp" };
+    bool image = imageSuffixes.contains(QFileInfo(path).suffix().toLower());
+    auto capture = std::make_shared<cv::VideoCapture>(path.toStdString(), image ? cv::CAP_IMAGES : cv::CAP_ANY);
+    return start(capture, true, handler);
+}
+
+bool OpenCvCapture::start(std::shared_ptr<cv::VideoCapture> capture, bool replay, const FrameHandler &handler)
+{
+    stop();
+    m_error.clear();
+
+    if (!capture->isOpened())
+    {
+        m_error = tr("cv::VideoCapture无法打开");
+        return false;
+    }
+
+    m_running = true;
+    m_thread = QThread::create([this, capture, replay, handler] { run(capture, replay, handler); });
+    m_thread->start();
+    return true;
+}
+
+void OpenCvCapture::stop()
+{
+    if (!m_thread)
+        return;
+
+    m_running = false;
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+bool OpenCvCapture::isActive() const
+{
+    return m_thread != nullptr && m_running;
+}
+
+void OpenCvCapture::run(std::shared_ptr<cv::VideoCapture> capture, bool replay, FrameHandler handler)
+{
+    // 回放按文件的帧率控制读取间隔
+    double fps = replay ? capture->get(cv::CAP_PROP_FPS) : 0.0;
+    if (replay && (fps <= 0.0 || fps > 240.0))
+        fps = DefaultFps;
+    QElapsedTimer clock;
+    clock.start();
+    qint64 frames = 0;
+
+    QElapsedTimer previewTimer;
+    previewTimer.start();
+    std::vector<Slot> buffers;
+
+    while (m_running)
+    {
+        // 读取到不再被识别任务引用的帧内存中，尺寸不变时OpenCV不重新分配
+        auto slot = std::find_if(buffers.begin(), buffers.end(), [](const Slot &s) { return s.frame.expired(); });
+        if (slot == buffers.end())
+            slot = buffers.insert(buffers.end(), Slot());
+
+        if (!capture->read(slot->mat) || slot->mat.empty())
+        {
+            if (replay)
+                emit finished();
+            else
+                emit errorOccurred(tr("无法读取相机帧"));
+            break;
+        }
+        // ImageViewFromMat按连续存储解释，ROI等非连续的帧先复制
+        if (!slot->mat.isContinuous())
+            slot->mat = slot->mat.clone();
+
+        auto view = ImageViewFromMat(slot->mat);
+        if (!view.data())
+        {
+            emit errorOccurred(tr("不支持的帧格式"));
+            break;
+        }
+
+        // 帧持有cv::Mat的引用，识别期间内存不会被下一次读取覆盖
+        cv::Mat mat = slot->mat;
+        Frame frame(new ZXing::ImageView(view), [mat](const ZXing::ImageView *view) {
+            delete view;
+            });
+        slot->frame = frame;
+
+        int interval = m_previewInterval;
+        if (interval > 0 && previewTimer.elapsed() >= interval)
+        {
+            previewTimer.restart();
+            emit previewReady(FrameView::toImage(*frame));
+        }
+        handler(frame);
+        frame.reset();
+
+        if (replay)
+        {
+            frames++;
+            qint64 wait = qRound64(frames * 1000.0 / fps) - clock.elapsed();
+            if (wait > 0)
+                QThread::msleep(static_cast<unsigned long>(wait));
+        }
+    }
+    m_running = false;
+}
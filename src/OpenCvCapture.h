@@ -0,0 +1,61 @@
+#pragma once
+
+#include <ZXing/ImageView.h>
+#include <QImage>
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class QThread;
+
+namespace cv {
+class VideoCapture;
+}
+
+// 基于cv::VideoCapture的采集
+// 打开相机、本地视频文件或图片序列，cv::Mat通过ImageViewFromMat直接包装为ZXing::ImageView，不做转换与复制；
+// 视频文件与图片序列按原帧率回放，可离线重现相机的识别过程
+class OpenCvCapture : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 采集的帧，引用全部释放后帧内存由下一次采集复用
+    using Frame = std::shared_ptr<const ZXing::ImageView>;
+    // 在采集线程中调用
+    using FrameHandler = std::function<void(const Frame &)>;
+
+    explicit OpenCvCapture(QObject *parent = nullptr);
+    ~OpenCvCapture();
+
+    // 打开相机，device为设备路径，为空时使用index
+    bool openCamera(const QString &device, int index, const FrameHandler &handler);
+    // 打开视频文件或图片序列并按原帧率回放，图片序列为printf格式如img_%04d.png，
+    // 或以数字编号结尾的第一张图片，由OpenCV从该编号开始依次读取
+    bool openFile(const QString &path, const FrameHandler &handler);
+    void stop();
+    bool isActive() const;
+    QString errorString() const { return m_error; }
+
+    // 预览图像的发送间隔(ms)，0为不发送
+    void setPreviewInterval(int ms) { m_previewInterval = ms; }
+
+signals:
+    // 按预览间隔发送的灰度图像，在采集线程中发出
+    void previewReady(const QImage &image);
+    // 视频文件或图片序列回放结束
+    void finished();
+    // 采集线程中发生错误后停止采集
+    void errorOccurred(const QString &error);
+
+private:
+    bool start(std::shared_ptr<cv::VideoCapture> capture, bool replay, const FrameHandler &handler);
+    void run(std::shared_ptr<cv::VideoCapture> capture, bool replay, FrameHandler handler);
+
+    QThread *m_thread = nullptr;
+    std::atomic<bool> m_running { false };
+    std::atomic<int> m_previewInterval { 200 };
+    QString m_error;
+};
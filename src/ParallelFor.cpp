@@ -0,0 +1,81 @@
+#include "ParallelFor.h"
+#include "DecodeExecutor.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <memory>
+
+namespace {
+
+// 各线程共享的任务状态，晚启动的线程在stop后直接退出，不访问调用方的数据
+struct ParallelState
+{
+    QMutex mutex;
+    QWaitCondition idle;
+    std::function<bool(int)> job;
+    int count = 0;
+    int next = 0;       // 下一个待执行的任务
+    int active = 0;     // 正在执行的线程数
+    bool stop = false;
+};
+
+void RunJobs(ParallelState &state)
+{
+    QMutexLocker locker(&state.mutex);
+    while (!state.stop && state.next < state.count)
+    {
+        int index = state.next++;
+        state.active++;
+        locker.unlock();
+
+        bool done = state.job(index);
+
+        locker.relock();
+        state.active--;
+        if (done)
+            state.stop = true;
+        state.idle.wakeAll();
+    }
+}
+
+} // namespace
+
+void ParallelFor(int count, const std::function<bool(int)> &job, QThreadPool *pool, int maxThreads)
+{
+    if (count <= 0)
+        return;
+    if (count == 1)
+    {
+        job(0);
+        return;
+    }
+
+    if (!pool)
+        pool = QThreadPool::globalInstance();
+    if (maxThreads <= 0)
+        maxThreads = pool->maxThreadCount();
+
+    auto state = std::make_shared<ParallelState>();
+    state->job = job;
+    state->count = count;
+
+    // 识别专用线程池的线程需先应用其优先级与CPU绑定
+    auto decodePool = dynamic_cast<DecodeThreadPool *>(pool);
+    int helpers = qMin(count, maxThreads) - 1;
+    for (int i = 0; i < helpers; i++)
+    {
+        pool->start([state, decodePool] {
+            if (decodePool)
+                decodePool->prepareThread();
+            RunJobs(*state);
+            });
+    }
+    RunJobs(*state);
+
+    QMutexLocker locker(&state->mutex);
+    while (state->active > 0)
+        state->idle.wait(&state->mutex);
+    // 返回后调用方的数据失效，阻止其余线程继续开始任务
+    state->stop = true;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <functional>
+
+class QThreadPool;
+
+// 在线程池中并行执行count个任务，当前线程也参与执行，因此线程池繁忙时不会死锁
+// job返回true时不再开始其余任务；函数返回时所有已开始的任务均已结束，未开始的任务不会再执行
+// pool为空时使用全局线程池，maxThreads为0时使用线程池的最大线程数
+void ParallelFor(int count, const std::function<bool(int)> &job, QThreadPool *pool = nullptr, int maxThreads = 0);
@@ -0,0 +1,327 @@
+#include "Preprocessor.h"
+#include "BufferPool.h"
+#include <QMutexLocker>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PREPROCESS_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define PREPROCESS_NEON
+#endif
+
+using ZXing::ImageFormat;
+
+namespace {
+
+// 锐化使用的均值滤波半径
+constexpr int SharpenRadius = 2;
+// 对比度归一化的局部窗口半径
+constexpr int ContrastRadius = 15;
+// 归一化后的局部平均偏差
+constexpr int TargetDeviation = 48;
+
+// 滤波器的中间图像，均为width x height的连续灰度图像
+struct Scratch
+{
+    uint8_t *plane0;
+    uint8_t *plane1;
+    uint16_t *columns;  // 均值滤波的列累加和，width个
+};
+
+using FilterFunc = void (*)(const uint8_t *src, uint8_t *dst, int w, int h, Scratch &scratch);
+
+inline size_t Offset(int y, int w)
+{
+    return static_cast<size_t>(y) * w;
+}
+
+// 三个数的中值
+inline uint8_t Median3(uint8_t a, uint8_t b, uint8_t c)
+{
+    return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+// 三行逐像素中值，返回已处理的像素数
+int Median3Row(const uint8_t *a, const uint8_t *b, const uint8_t *c, uint8_t *dst, int n)
+{
+    int x = 0;
+#if defined(PREPROCESS_SSE2)
+    for (; x + 16 <= n; x += 16)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + x));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+        __m128i vc = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c + x));
+        __m128i m = _mm_max_epu8(_mm_min_epu8(va, vb), _mm_min_epu8(_mm_max_epu8(va, vb), vc));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), m);
+    }
+#elif defined(PREPROCESS_NEON)
+    for (; x + 16 <= n; x += 16)
+    {
+        uint8x16_t va = vld1q_u8(a + x), vb = vld1q_u8(b + x), vc = vld1q_u8(c + x);
+        vst1q_u8(dst + x, vmaxq_u8(vminq_u8(va, vb), vminq_u8(vmaxq_u8(va, vb), vc)));
+    }
+#endif
+    for (; x < n; x++)
+        dst[x] = Median3(a[x], b[x], c[x]);
+    return x;
+}
+
+// 列累加和加上add行并减去sub行
+void UpdateColumns(uint16_t *columns, const uint8_t *add, const uint8_t *sub, int w)
+{
+    int x = 0;
+#if defined(PREPROCESS_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= w; x += 16)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(add + x));
+        __m128i vs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sub + x));
+        auto *col = reinterpret_cast<__m128i *>(columns + x);
+        __m128i lo = _mm_loadu_si128(col);
+        __m128i hi = _mm_loadu_si128(col + 1);
+        lo = _mm_sub_epi16(_mm_add_epi16(lo, _mm_unpacklo_epi8(va, zero)), _mm_unpacklo_epi8(vs, zero));
+        hi = _mm_sub_epi16(_mm_add_epi16(hi, _mm_unpackhi_epi8(va, zero)), _mm_unpackhi_epi8(vs, zero));
+        _mm_storeu_si128(col, lo);
+        _mm_storeu_si128(col + 1, hi);
+    }
+#elif defined(PREPROCESS_NEON)
+    for (; x + 8 <= w; x += 8)
+    {
+        uint16x8_t col = vld1q_u16(columns + x);
+        vst1q_u16(columns + x, vsubw_u8(vaddw_u8(col, vld1_u8(add + x)), vld1_u8(sub + x)));
+    }
+#endif
+    for (; x < w; x++)
+        columns[x] = static_cast<uint16_t>(columns[x] + add[x] - sub[x]);
+}
+
+// (2r+1)x(2r+1)均值滤波，边缘像素重复；列方向累加和逐行增量更新，行方向滑动求和
+void BoxBlur(const uint8_t *src, uint8_t *dst, int w, int h, int r, uint16_t *columns)
+{
+    auto row = [&](int y) { return src + Offset(qBound(0, y, h - 1), w); };
+
+    std::fill(columns, columns + w, uint16_t(0));
+    for (int k = -r; k <= r; k++)
+    {
+        const uint8_t *p = row(k);
+        for (int x = 0; x < w; x++)
+            columns[x] += p[x];
+    }
+
+    // 除以窗口面积转换为定点乘法
+    const uint64_t area = static_cast<uint64_t>(2 * r + 1) * (2 * r + 1);
+    const uint64_t mul = ((uint64_t(1) << 24) + area / 2) / area;
+    for (int y = 0; y < h; y++)
+    {
+        uint8_t *out = dst + Offset(y, w);
+        uint32_t sum = 0;
+        for (int k = -r; k <= r; k++)
+            sum += columns[qBound(0, k, w - 1)];
+        for (int x = 0; x < w; x++)
+        {
+            out[x] = static_cast<uint8_t>((sum * mul + (uint64_t(1) << 23)) >> 24);
+            sum += columns[qMin(x + r + 1, w - 1)];
+            sum -= columns[qMax(x - r, 0)];
+        }
+        if (y + 1 < h)
+            UpdateColumns(columns, row(y + r + 1), row(y - r), w);
+    }
+}
+
+// 可分离3x3中值滤波：先行方向再列方向取三点中值
+void DenoiseFilter(const uint8_t *src, uint8_t *dst, int w, int h, Scratch &scratch)
+{
+    uint8_t *tmp = scratch.plane0;
+    for (int y = 0; y < h; y++)
+    {
+        const uint8_t *s = src + Offset(y, w);
+        uint8_t *t = tmp + Offset(y, w);
+        t[0] = s[0];
+        t[w - 1] = s[w - 1];
+        if (w > 2)
+            Median3Row(s, s + 1, s + 2, t + 1, w - 2);
+    }
+    for (int y = 0; y < h; y++)
+    {
+        const uint8_t *above = tmp + Offset(qMax(y - 1, 0), w);
+        const uint8_t *below = tmp + Offset(qMin(y + 1, h - 1), w);
+        Median3Row(above, tmp + Offset(y, w), below, dst + Offset(y, w), w);
+    }
+}
+
+// 局部对比度归一化：减去局部均值后按局部平均偏差放大，使各区域的对比度接近
+void ContrastFilter(const uint8_t *src, uint8_t *dst, int w, int h, Scratch &scratch)
+{
+    uint8_t *mean = scratch.plane0;
+    uint8_t *deviation = scratch.plane1;
+    BoxBlur(src, mean, w, h, ContrastRadius, scratch.columns);
+
+    // 与局部均值之差的绝对值暂存于输出图像
+    const size_t size = Offset(h, w);
+    size_t i = 0;
+#if defined(PREPROCESS_SSE2)
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mean + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a)));
+    }
+#elif defined(PREPROCESS_NEON)
+    for (; i + 16 <= size; i += 16)
+        vst1q_u8(dst + i, vabdq_u8(vld1q_u8(src + i), vld1q_u8(mean + i)));
+#endif
+    for (; i < size; i++)
+        dst[i] = static_cast<uint8_t>(std::abs(src[i] - mean[i]));
+    BoxBlur(dst, deviation, w, h, ContrastRadius, scratch.columns);
+
+    // 放大倍数(8位定点)按平均偏差查表，限制在0.5到8倍之间
+    static const auto gains = [] {
+        std::array<int, 256> table {};
+        for (int d = 0; d < 256; d++)
+            table[d] = qBound(128, TargetDeviation * 256 / qMax(d, 1), 2048);
+        return table;
+    }();
+    for (i = 0; i < size; i++)
+    {
+        int value = 128 + (((src[i] - mean[i]) * gains[deviation[i]]) >> 8);
+        dst[i] = static_cast<uint8_t>(qBound(0, value, 255));
+    }
+}
+
+// 反锐化掩模：原图加上原图与均值滤波图像之差，即2*src - blur
+void SharpenFilter(const uint8_t *src, uint8_t *dst, int w, int h, Scratch &scratch)
+{
+    uint8_t *blur = scratch.plane0;
+    BoxBlur(src, blur, w, h, SharpenRadius, scratch.columns);
+
+    // src + (src - blur)的正负两部分分别饱和加减，结果即限制在0~255的2*src - blur
+    const size_t size = Offset(h, w);
+    size_t i = 0;
+#if defined(PREPROCESS_SSE2)
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(blur + i));
+        __m128i v = _mm_subs_epu8(_mm_adds_epu8(s, _mm_subs_epu8(s, b)), _mm_subs_epu8(b, s));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v);
+    }
+#elif defined(PREPROCESS_NEON)
+    for (; i + 16 <= size; i += 16)
+    {
+        uint8x16_t s = vld1q_u8(src + i), b = vld1q_u8(blur + i);
+        vst1q_u8(dst + i, vqsubq_u8(vqaddq_u8(s, vqsubq_u8(s, b)), vqsubq_u8(b, s)));
+    }
+#endif
+    for (; i < size; i++)
+        dst[i] = static_cast<uint8_t>(qBound(0, 2 * src[i] - blur[i], 255));
+}
+
+// 按应用顺序排列的滤波器
+const std::array<std::pair<Preprocessor::Filter, FilterFunc>, 3> Filters = { {
+    { Preprocessor::Denoise, DenoiseFilter },
+    { Preprocessor::Contrast, ContrastFilter },
+    { Preprocessor::Sharpen, SharpenFilter },
+} };
+
+// 复制为连续存储的灰度图像
+void Gather(const ZXing::ImageView &image, uint8_t *dst)
+{
+    const int w = image.width();
+    const int h = image.height();
+    const int ps = image.pixStride();
+    const auto fmt = image.format();
+    const int r = ZXing::RedIndex(fmt), g = ZXing::GreenIndex(fmt), b = ZXing::BlueIndex(fmt);
+
+    for (int y = 0; y < h; y++)
+    {
+        const uint8_t *src = image.data(0, y);
+        uint8_t *out = dst + Offset(y, w);
+        if (fmt == ImageFormat::Lum && ps == 1)
+            std::memcpy(out, src, w);
+        else if (fmt == ImageFormat::Lum || fmt == ImageFormat::LumA)
+            for (int x = 0; x < w; x++)
+                out[x] = src[x * ps];
+        else
+            for (int x = 0; x < w; x++, src += ps)
+                out[x] = ZXing::RGBToLum(src[r], src[g], src[b]);
+    }
+}
+
+} // namespace
+
+ZXing::ImageView Preprocessor::apply(const ZXing::ImageView &image, int filters, std::vector<uint8_t> &buffer)
+{
+    const int w = image.width();
+    const int h = image.height();
+    const size_t size = Offset(h, w);
+    buffer.resize(size);
+
+    int count = 0;
+    for (auto &filter : Filters)
+        count += (filters & filter.first) ? 1 : 0;
+    if (count == 0)
+    {
+        Gather(image, buffer.data());
+        return { buffer.data(), w, h, ImageFormat::Lum };
+    }
+
+    // 中间图像从线程的缓冲池借用，返回前归还
+    auto &pool = BufferPool::local();
+    auto pingBuffer = pool.acquire(size);
+    auto plane0 = pool.acquire(size);
+    auto columns = pool.acquire(static_cast<size_t>(w) * sizeof(uint16_t));
+    BufferPool::Buffer plane1;
+    if (filters & Contrast)
+    {
+        plane1 = pool.acquire(size);
+        plane1.storage().resize(size);
+    }
+    pingBuffer.storage().resize(size);
+    plane0.storage().resize(size);
+    columns.storage().resize(static_cast<size_t>(w) * sizeof(uint16_t));
+
+    // 输出图像与一块中间图像交替作为各滤波器的输入输出，
+    // 滤波器个数为奇数时从中间图像开始，使最后一个滤波器写入输出图像
+    uint8_t *ping = pingBuffer.storage().data();
+    uint8_t *src = count % 2 == 1 ? ping : buffer.data();
+    uint8_t *dst = count % 2 == 1 ? buffer.data() : ping;
+    Gather(image, src);
+
+    Scratch scratch = { plane0.storage().data(), plane1.storage().data(),
+        reinterpret_cast<uint16_t *>(columns.storage().data()) };
+    for (auto &filter : Filters)
+    {
+        if (!(filters & filter.first))
+            continue;
+        filter.second(src, dst, w, h, scratch);
+        std::swap(src, dst);
+    }
+
+    return { buffer.data(), w, h, ImageFormat::Lum };
+}
+
+void Preprocessor::record(double ms, bool hit)
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats.frames++;
+    m_stats.hits += hit ? 1 : 0;
+    m_stats.totalTime += ms;
+}
+
+Preprocessor::Stats Preprocessor::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+void Preprocessor::resetStats()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats = {};
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <ZXing/ImageView.h>
+#include <QMutex>
+#include <vector>
+
+// 识别前的图像预处理
+// 按降噪、局部对比度归一化、锐化的顺序对灰度图像依次滤波，中间图像从线程的缓冲池借用；
+// 各滤波器使用向量运算，并统计每帧预处理的耗时与预处理后识别的命中率
+class Preprocessor
+{
+public:
+    enum Filter
+    {
+        None = 0,
+        Denoise = 1,    // 3x3可分离中值滤波，去除噪点且保留边缘
+        Contrast = 2,   // 局部对比度归一化，改善低对比度与反光区域
+        Sharpen = 4,    // 反锐化掩模，增强模糊的边缘
+    };
+
+    struct Stats
+    {
+        quint64 frames = 0;     // 预处理的帧数
+        quint64 hits = 0;       // 预处理后识别到结果的帧数
+        double totalTime = 0.0; // 累计预处理耗时(ms)
+    };
+
+    Preprocessor() = default;
+
+    // 对image依次应用filters中的滤波器，返回连续存储的灰度图像，buffer为输出图像内存
+    static ZXing::ImageView apply(const ZXing::ImageView &image, int filters, std::vector<uint8_t> &buffer);
+
+    // 记录一帧的预处理耗时与识别结果
+    void record(double ms, bool hit);
+    Stats stats() const;
+    void resetStats();
+
+private:
+    mutable QMutex m_mutex;
+    Stats m_stats;
+};
@@ -0,0 +1,147 @@
+#include "PyramidDecoder.h"
+#include "BufferPool.h"
+#include "DecodeResults.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PYRAMID_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define PYRAMID_NEON
+#endif
+
+using ZXing::ImageFormat;
+
+// 两行连续灰度像素2x2均值缩小，返回已处理的输出像素数
+static int DownscaleRow(const uint8_t *row0, const uint8_t *row1, uint8_t *dst, int outWidth)
+{
+    int x = 0;
+#if defined(PYRAMID_SSE2)
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    const __m128i two = _mm_set1_epi16(2);
+    for (; x + 16 <= outWidth; x += 16)
+    {
+        __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 2 * x));
+        __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 2 * x + 16));
+        __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 2 * x));
+        __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 2 * x + 16));
+        // 偶数与奇数像素分别扩展为16位后相加
+        __m128i s0 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a0, mask), _mm_srli_epi16(a0, 8)),
+            _mm_add_epi16(_mm_and_si128(b0, mask), _mm_srli_epi16(b0, 8)));
+        __m128i s1 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a1, mask), _mm_srli_epi16(a1, 8)),
+            _mm_add_epi16(_mm_and_si128(b1, mask), _mm_srli_epi16(b1, 8)));
+        s0 = _mm_srli_epi16(_mm_add_epi16(s0, two), 2);
+        s1 = _mm_srli_epi16(_mm_add_epi16(s1, two), 2);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(s0, s1));
+    }
+#elif defined(PYRAMID_NEON)
+    for (; x + 8 <= outWidth; x += 8)
+    {
+        uint16x8_t s = vaddq_u16(vpaddlq_u8(vld1q_u8(row0 + 2 * x)), vpaddlq_u8(vld1q_u8(row1 + 2 * x)));
+        vst1_u8(dst + x, vrshrn_n_u16(s, 2));
+    }
+#endif
+    return x;
+}
+
+ZXing::ImageView PyramidDecoder::downscale(const ZXing::ImageView &image, std::vector<uint8_t> &buffer)
+{
+    const int w = image.width() / 2;
+    const int h = image.height() / 2;
+    const int ps = image.pixStride();
+    const auto fmt = image.format();
+    const bool lum = fmt == ImageFormat::Lum || fmt == ImageFormat::LumA;
+    const int r = ZXing::RedIndex(fmt), g = ZXing::GreenIndex(fmt), b = ZXing::BlueIndex(fmt);
+    buffer.resize(static_cast<size_t>(w) * h);
+
+    auto luma = [&](const uint8_t *p) -> unsigned {
+        return lum ? p[0] : ZXing::RGBToLum(p[r], p[g], p[b]);
+        };
+
+    for (int y = 0; y < h; y++)
+    {
+        const uint8_t *row0 = image.data(0, 2 * y);
+        const uint8_t *row1 = image.data(0, 2 * y + 1);
+        uint8_t *dst = buffer.data() + static_cast<size_t>(y) * w;
+        // 连续存储的灰度图像使用向量运算
+        int x = fmt == ImageFormat::Lum && ps == 1 ? DownscaleRow(row0, row1, dst, w) : 0;
+        for (; x < w; x++)
+        {
+            const uint8_t *p0 = row0 + 2 * x * ps;
+            const uint8_t *p1 = row1 + 2 * x * ps;
+            dst[x] = static_cast<uint8_t>((luma(p0) + luma(p0 + ps) + luma(p1) + luma(p1 + ps) + 2) / 4);
+        }
+    }
+
+    return { buffer.data(), w, h, ImageFormat::Lum };
+}
+
+ZXing::Barcodes PyramidDecoder::decode(const ZXing::ImageView &image, int levels, const DecodeFunc &decode,
+    QDeadlineTimer deadline)
+{
+    // 尺度图像内存从线程的缓冲池借用
+    std::array<BufferPool::Buffer, MaxLevels> buffers;
+
+    std::array<ZXing::ImageView, MaxLevels> pyramid;
+    pyramid[0] = image;
+    int count = 1;
+    levels = qBound(1, levels, MaxLevels);
+    while (count < levels && qMin(pyramid[count - 1].width(), pyramid[count - 1].height()) / 2 >= MinSize)
+    {
+        auto &prev = pyramid[count - 1];
+        buffers[count] = BufferPool::local().acquire(static_cast<size_t>(prev.width() / 2) * (prev.height() / 2));
+        pyramid[count] = downscale(prev, buffers[count].storage());
+        count++;
+    }
+
+    // 从最小尺度开始识别，各尺度均未解码成功时返回最大尺度定位到的条码
+    ZXing::Barcodes failed;
+    for (int level = count - 1; level >= 0; level--)
+    {
+        if (level != count - 1 && deadline.hasExpired())
+            break;
+
+        QElapsedTimer timer;
+        timer.start();
+        auto results = decode(pyramid[level]);
+        bool hit = HasValidResult(results);
+        record(level, hit, timer.nsecsElapsed() / 1e6);
+
+        if (results.empty())
+            continue;
+
+        // 尺度坐标转换为原图坐标
+        if (level > 0)
+        {
+            for (auto &result : results)
+                result.setPosition(ZXing::Scale(result.position(), 1 << level));
+        }
+        if (hit)
+            return results;
+        failed = std::move(results);
+    }
+    return failed;
+}
+
+std::array<PyramidDecoder::LevelStats, PyramidDecoder::MaxLevels> PyramidDecoder::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+void PyramidDecoder::resetStats()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats = {};
+}
+
+void PyramidDecoder::record(int level, bool hit, double ms)
+{
+    QMutexLocker locker(&m_mutex);
+    auto &s = m_stats[level];
+    s.attempts++;
+    s.hits += hit ? 1 : 0;
+    s.totalTime += ms;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ZXing/ReadBarcode.h>
+#include <QDeadlineTimer>
+#include <QMutex>
+#include <array>
+#include <functional>
+#include <vector>
+
+// 多尺度金字塔识别
+// 每帧以2x2均值滤波逐级缩小一半生成若干尺度，从最小尺度向原始尺度依次识别，任一尺度识别到结果即停止；
+// 大尺寸条码在缩小的图像上即可快速识别，小尺寸条码最终在原始分辨率上识别
+class PyramidDecoder
+{
+public:
+    using DecodeFunc = std::function<ZXing::Barcodes(const ZXing::ImageView &)>;
+
+    static constexpr int MaxLevels = 4;
+    // 最小尺度的短边不小于该值
+    static constexpr int MinSize = 160;
+
+    struct LevelStats
+    {
+        quint64 attempts = 0;   // 识别次数
+        quint64 hits = 0;       // 识别到结果的次数
+        double totalTime = 0.0; // 累计耗时(ms)
+    };
+
+    PyramidDecoder() = default;
+
+    // levels为使用的尺度数，1表示仅识别原图；decode为单个尺度的识别函数，可在任意线程调用；
+    // 超过截止时间后不再识别更大的尺度
+    ZXing::Barcodes decode(const ZXing::ImageView &image, int levels, const DecodeFunc &decode,
+        QDeadlineTimer deadline = QDeadlineTimer(QDeadlineTimer::Forever));
+
+    std::array<LevelStats, MaxLevels> stats() const;
+    void resetStats();
+
+    // 2x2均值缩小为一半尺寸的灰度图像，buffer为输出图像内存
+    static ZXing::ImageView downscale(const ZXing::ImageView &image, std::vector<uint8_t> &buffer);
+
+private:
+    void record(int level, bool hit, double ms);
+
+    mutable QMutex m_mutex;
+    std::array<LevelStats, MaxLevels> m_stats;
+};
@@ -13,6 +13,7 @@
 #include <QImageCapture>
 #include <QMediaCaptureSession>
 #include <QMediaDevices>
+#include <QVideoSink>
 #endif // QT5VER
 
 #include <QMessageBox>
@@ -22,18 +23,35 @@
 #include <QPainter>
 #include <QPainterPath>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QLabel>
+#include <atomic>
 
 #include <ZXing/ReadBarcode.h>
 
-#include "ZXingQtReader.h"
 #include "QRCodeGenerator.h"
 #include "ImageView.h"
+#include "BufferPool.h"
+#include "DecodeResults.h"
+#include "FrameView.h"
+#include "TiledDecoder.h"
+#ifdef HAVE_V4L2
+#include "V4l2Capture.h"
+#endif // HAVE_V4L2
+#ifdef HAVE_OPENCV
+#include "OpenCvCapture.h"
+#endif // HAVE_OPENCV
+#include "VariantDecoder.h"
 
 QRCodeScanner::QRCodeScanner(QWidget *parent)
     : QMainWindow(parent)
 {
     ui.setupUi(this);
 
+    // 主相机识别通道
+    m_lane = std::make_shared<ScanLane>(tr("主相机"));
+    m_pool.addLane(m_lane);
+
 #ifdef QT5VER
     // Qt5需要注册该类型用于属性与信号槽
     qRegisterMetaType<QList<QPolygon>>("QList<QPolygon>");
@@ -53,20 +71,98 @@ QRCodeScanner::QRCodeScanner(QWidget *parent)
     ui.previewFrameLayout->addWidget(m_videoWidget);
     // 图像捕获定时器
     m_timer = new QTimer(this);
-    m_timer->setInterval(300);
-    // 注意：启用深度识别时用时将会显著增加，需要控制定时器采集间隔
-#if QT_VERSION < QT_VERSION_CHECK(6, 7, 0)
-    connect(ui.tryHarderBox, &QCheckBox::stateChanged, this, [=](int state) {
-#else
-    connect(ui.tryHarderBox, &QCheckBox::checkStateChanged, this, [=](Qt::CheckState state) {
-#endif
-        if (state != 0)
-            m_timer->setInterval(1500);
-        else
-            m_timer->setInterval(300);
+    m_timer->setInterval(m_lane->scheduler.interval());
+    // 采集间隔由实测识别耗时决定，识别参数改变时耗时随之变化，重新统计
+    m_lane->scheduler.setCpuBudget(ui.cpuBudgetBox->value() / 100.0);
+    connect(ui.cpuBudgetBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [=](int value) {
+        for (auto &lane : m_pool.lanes())
+            lane->scheduler.setCpuBudget(value / 100.0);
+        });
+    // 目标延迟限制采集间隔的上限，0为不限
+    m_lane->scheduler.setTargetLatency(ui.targetLatencyBox->value());
+    connect(ui.targetLatencyBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [=](int value) {
+        for (auto &lane : m_pool.lanes())
+            lane->scheduler.setTargetLatency(value);
+        });
+    connect(ui.tryHarderBox, &QCheckBox::toggled, this, [=] {
+        for (auto &lane : m_pool.lanes())
+            lane->scheduler.reset();
+        });
+
+    // 二值化算法，自动时各相机分别采样选择
+    ui.binarizerBox->addItem(tr("自动"), -1);
+    for (auto binarizer : { ZXing::Binarizer::LocalAverage, ZXing::Binarizer::GlobalHistogram, ZXing::Binarizer::FixedThreshold, ZXing::Binarizer::BoolCast })
+        ui.binarizerBox->addItem(BinarizerTuner::name(binarizer), static_cast<int>(binarizer));
+
+    // 识别设置仅在控件改变时重新构建
+    updateSettings();
+    for (auto box : { ui.linearCodesBox, ui.matrixCodesBox, ui.tryHarderBox, ui.tryRotateBox, ui.tryInvertBox, ui.tryDenoiseBox, ui.cascadeBox, ui.parallelBox, ui.tiledBox, ui.tryDownscaleBox, ui.autoDownscaleBox, ui.rectifyBox, ui.formatPriorityBox, ui.resultCacheBox, ui.continuousBox, ui.trackingBox, ui.changeGateBox })
+    {
+        connect(box, &QCheckBox::toggled, this, &QRCodeScanner::updateSettings);
+    }
+    connect(ui.frameDeadlineBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &QRCodeScanner::updateSettings);
+    for (auto box : { ui.trackingIntervalBox, ui.trackingMarginBox })
+        connect(box, QOverload<int>::of(&QSpinBox::valueChanged), this, &QRCodeScanner::updateSettings);
+    connect(ui.trackingBox, &QCheckBox::toggled, ui.trackingIntervalBox, &QSpinBox::setEnabled);
+    connect(ui.trackingBox, &QCheckBox::toggled, ui.trackingMarginBox, &QSpinBox::setEnabled);
+    connect(ui.binarizerBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &QRCodeScanner::updateSettings);
+    for (auto box : { ui.downscaleThresholdBox, ui.downscaleFactorBox })
+        connect(box, QOverload<int>::of(&QSpinBox::valueChanged), this, &QRCodeScanner::updateSettings);
+    // 预处理方式改变时重新统计耗时与命中率
+    for (auto box : { ui.denoiseBox, ui.contrastBox, ui.sharpenBox, ui.preprocessAlwaysBox })
+    {
+        connect(box, &QCheckBox::toggled, this, [=] {
+            m_preprocess.resetStats();
+            for (auto &lane : m_pool.lanes())
+                lane->preprocess.resetStats();
+            updateSettings();
+            });
+    }
+    // 自动调整时手动参数仅在样本不足时使用
+    connect(ui.tryDownscaleBox, &QCheckBox::toggled, ui.autoDownscaleBox, &QCheckBox::setEnabled);
+
+    connect(ui.pyramidLevelsBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [=] {
+        m_pyramid.resetStats();
+        updateSettings();
+        });
+
+    // 识别结果磁盘缓存
+    auto setCacheDirectory = [=](bool persistent) {
+        m_cache.setDirectory(persistent ? QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/results" : QString());
+        };
+    setCacheDirectory(ui.persistentCacheBox->isChecked());
+    connect(ui.persistentCacheBox, &QCheckBox::toggled, this, setCacheDirectory);
+    connect(ui.resultCacheBox, &QCheckBox::toggled, ui.persistentCacheBox, &QCheckBox::setEnabled);
+    connect(ui.clearCacheBtn, &QPushButton::clicked, this, [=] {
+        m_cache.clear();
+        ui.statusBar->showMessage(tr("识别结果缓存已清除"));
+        });
+
+    // 识别线程数与绑定的CPU核心
+    connect(ui.decodeThreadsBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [=](int value) {
+        m_executor.setWorkerCount(value);
+        m_pool.setMaxWorkers(value);
+        });
+    connect(ui.cpuCoresEdit, &QLineEdit::editingFinished, this, [=] {
+        auto cores = DecodeExecutor::parseCores(ui.cpuCoresEdit->text());
+        m_executor.setCores(cores);
+        QStringList list;
+        for (int core : cores)
+            list << QString::number(core);
+        ui.cpuCoresEdit->setText(list.join(','));
+        });
+
+    // 连续扫描重复抑制时间窗口
+    m_duplicates.setWindow(ui.dedupWindowBox->value() * 1000);
+    connect(ui.dedupWindowBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [=](int value) {
+        m_duplicates.setWindow(value * 1000);
         });
 
 #ifdef QT5VER
+    // Qt5不支持QVideoSink，仅使用定时图像捕获
+    ui.streamModeBox->setChecked(false);
+    ui.streamModeBox->setVisible(false);
+    ui.multiCameraBox->setVisible(false);
     connect(ui.cameraComBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &QRCodeScanner::onCameraIndexChanged);
 #else
     m_camera = new QCamera(this);
@@ -85,10 +181,58 @@ QRCodeScanner::QRCodeScanner(QWidget *parent)
     // 图像捕获
     auto imageCapture = new QImageCapture(this);
     capture->setImageCapture(imageCapture);
-    connect(m_timer, &QTimer::timeout, imageCapture, &QImageCapture::capture);
+    // 采集间隔可能短于一次捕获的耗时，上一次捕获未完成时跳过
+    connect(m_timer, &QTimer::timeout, imageCapture, [=] {
+        if (imageCapture->isReadyForCapture())
+            imageCapture->capture();
+        });
     connect(imageCapture, &QImageCapture::imageCaptured, this, &QRCodeScanner::recognImage);
+
+    // 视频流：直接识别视频输出的帧，省去静态图像捕获的编解码开销
+    connect(m_videoWidget->videoSink(), &QVideoSink::videoFrameChanged, this, &QRCodeScanner::recognFrame);
 #endif // QT5VER
 
+#ifdef HAVE_V4L2
+    // V4L2直接采集，驱动缓冲区中的帧不经转换直接识别，预览定时显示灰度图像
+    m_v4l2 = new V4l2Capture(this);
+    connect(m_v4l2, &V4l2Capture::previewReady, this, [=](const QImage &img) {
+        if (ui.stopBtn->isEnabled())
+            m_viewer->setImage(img);
+        });
+    connect(m_v4l2, &V4l2Capture::errorOccurred, this, [=](const QString &error) {
+        ui.stopBtn->click();
+        ui.statusBar->showMessage(tr("V4L2采集发生错误：%1").arg(error));
+        });
+#else
+    ui.v4l2Box->setChecked(false);
+    ui.v4l2Box->setVisible(false);
+#endif // HAVE_V4L2
+
+#ifdef HAVE_OPENCV
+    // OpenCV采集，cv::Mat直接识别；也用于离线回放视频文件与图片序列
+    m_opencv = new OpenCvCapture(this);
+    connect(m_opencv, &OpenCvCapture::previewReady, this, [=](const QImage &img) {
+        if (ui.stopBtn->isEnabled())
+            m_viewer->setImage(img);
+        });
+    connect(m_opencv, &OpenCvCapture::finished, this, [=] {
+        if (!ui.stopBtn->isEnabled())
+            return;
+        ui.stopBtn->click();
+        ui.statusBar->showMessage(tr("回放结束"));
+        });
+    connect(m_opencv, &OpenCvCapture::errorOccurred, this, [=](const QString &error) {
+        ui.stopBtn->click();
+        ui.statusBar->showMessage(tr("OpenCV采集发生错误：%1").arg(error));
+        });
+    // 菜单->回放视频
+    connect(ui.action_openVideo, &QAction::triggered, this, &QRCodeScanner::openVideoFile);
+#else
+    ui.opencvBox->setChecked(false);
+    ui.opencvBox->setVisible(false);
+    ui.action_openVideo->setVisible(false);
+#endif // HAVE_OPENCV
+
     freshCameras();
 
     if (ui.cameraComBox->count() > 0)
@@ -103,9 +247,140 @@ QRCodeScanner::QRCodeScanner(QWidget *parent)
         QMessageBox::warning(this, tr("提示"), tr("图片未识别到一维/二维码。"));
         });
 
-    // TODO
-    //auto fpsLabel = new QLabel("FPS: 0", this);
-    //ui.statusBar->addPermanentWidget(fpsLabel);
+    // 状态栏显示每秒识别帧数、累计丢帧数、跳过帧数与当前采集间隔，多相机时分别显示各相机的帧率与识别耗时
+    auto fpsLabel = new QLabel("FPS: 0", this);
+    ui.statusBar->addPermanentWidget(fpsLabel);
+    auto statsTimer = new QTimer(this);
+    connect(statsTimer, &QTimer::timeout, this, [=] {
+        QStringList stats;
+        auto lanes = m_pool.lanes();
+        for (auto &lane : lanes)
+        {
+            auto processed = lane->mailbox.processed();
+            auto fps = processed - lane->lastProcessed;
+            lane->lastProcessed = processed;
+            if (lanes.size() == 1)
+            {
+                stats << tr("FPS: %1  丢帧: %2  超时: %3  跳过: %4  间隔: %5ms").arg(fps)
+                    .arg(lane->mailbox.dropped()).arg(lane->mailbox.abandoned()).arg(lane->gate.skipped())
+                    .arg(lane->scheduler.interval());
+            }
+            else
+            {
+                stats << tr("%1: %2 FPS %3ms").arg(lane->name).arg(fps).arg(qRound(lane->scheduler.averageTime()));
+            }
+        }
+        fpsLabel->setText(stats.join(" | "));
+
+        // 分级识别各级的命中率与平均耗时
+        QStringList tiers;
+        auto tierStats = m_cascade.stats();
+        for (int i = 0; i < DecodeCascade::TierCount; i++)
+        {
+            auto &s = tierStats[i];
+            if (s.attempts == 0)
+                continue;
+            tiers << tr("%1: 命中率 %2%  平均 %3ms  超时跳过 %4").arg(DecodeCascade::tierName(i))
+                .arg(100.0 * s.hits / s.attempts, 0, 'f', 1).arg(s.totalTime / s.attempts, 0, 'f', 1).arg(s.skipped);
+        }
+        // 多尺度识别各尺度的命中率与平均耗时
+        auto levelStats = m_pyramid.stats();
+        for (int i = PyramidDecoder::MaxLevels - 1; i >= 0; i--)
+        {
+            auto &s = levelStats[i];
+            if (s.attempts == 0)
+                continue;
+            tiers << tr("1/%1尺度: 命中率 %2%  平均 %3ms").arg(1 << i)
+                .arg(100.0 * s.hits / s.attempts, 0, 'f', 1).arg(s.totalTime / s.attempts, 0, 'f', 1);
+        }
+        // 识别到的各格式占比
+        auto histogram = m_formats.histogram();
+        if (!histogram.isEmpty())
+        {
+            quint64 total = 0;
+            for (auto &entry : histogram)
+                total += entry.second;
+            QStringList formats;
+            for (auto &entry : histogram)
+            {
+                formats << tr("%1 %2%").arg(QString::fromStdString(ZXing::ToString(entry.first)))
+                    .arg(100.0 * entry.second / total, 0, 'f', 1);
+            }
+            tiers << tr("格式: %1  (优先 %2 次, 全格式 %3 次)").arg(formats.join(", "))
+                .arg(m_formats.priorityPasses()).arg(m_formats.fullPasses());
+        }
+        // 各相机选用的二值化算法
+        if (ui.binarizerBox->currentIndex() == 0)
+        {
+            for (auto &lane : lanes)
+            {
+                tiers << tr("%1 二值化: %2%3").arg(lane->name).arg(BinarizerTuner::name(lane->binarizer.current()))
+                    .arg(lane->binarizer.isLocked() ? QString() : tr(" (采样中)"));
+            }
+        }
+        // 各相机区域识别与整帧识别的帧数
+        if (ui.trackingBox->isChecked())
+        {
+            for (auto &lane : lanes)
+            {
+                tiers << tr("%1 区域跟踪: 区域 %2 帧  整帧 %3 帧").arg(lane->name)
+                    .arg(lane->tracker.roiFrames()).arg(lane->tracker.fullFrames());
+            }
+        }
+        // 各相机自动选择的缩小识别参数
+        if (ui.tryDownscaleBox->isChecked() && ui.autoDownscaleBox->isChecked())
+        {
+            for (auto &lane : lanes)
+            {
+                auto size = lane->downscale.codeSize();
+                auto profile = lane->downscale.current();
+                if (size <= 0)
+                    tiers << tr("%1 缩小识别: 样本不足，使用手动参数").arg(lane->name);
+                else if (!profile.enabled)
+                    tiers << tr("%1 缩小识别: 条码约 %2px，不缩小").arg(lane->name).arg(size);
+                else
+                    tiers << tr("%1 缩小识别: 条码约 %2px，阈值 %3px  倍数 %4").arg(lane->name).arg(size)
+                        .arg(profile.threshold).arg(profile.factor);
+            }
+        }
+        // 各相机与图片文件每帧预处理的平均耗时及预处理后的命中率
+        auto addPreprocess = [&](const QString &name, const Preprocessor &preprocessor) {
+            auto s = preprocessor.stats();
+            if (s.frames == 0)
+                return;
+            tiers << tr("%1 预处理: %2 帧  平均 %3ms  命中率 %4%").arg(name).arg(s.frames)
+                .arg(s.totalTime / s.frames, 0, 'f', 1).arg(100.0 * s.hits / s.frames, 0, 'f', 1);
+            };
+        for (auto &lane : lanes)
+            addPreprocess(lane->name, lane->preprocess);
+        addPreprocess(tr("图片"), m_preprocess);
+        // 透视校正的候选区域数与命中率
+        auto rectify = m_rectify.stats();
+        if (rectify.attempts > 0)
+        {
+            tiers << tr("透视校正: %1 帧  候选 %2  命中率 %3%  平均 %4ms").arg(rectify.attempts).arg(rectify.candidates)
+                .arg(100.0 * rectify.hits / rectify.attempts, 0, 'f', 1).arg(rectify.totalTime / rectify.attempts, 0, 'f', 1);
+        }
+        // 帧缓冲池的申请与实际分配次数，稳定运行时分配次数不再增加
+        auto buffers = BufferPool::stats();
+        tiers << tr("帧缓冲: 申请 %1 次  分配 %2 次").arg(buffers.acquired).arg(buffers.allocated);
+        // 正在收集的结构化追加序列
+        auto pending = m_sequences.pending();
+        if (!pending.isEmpty())
+            tiers << tr("结构化追加: %1").arg(pending.join(", "));
+        fpsLabel->setToolTip(tiers.join("\n"));
+        // 定时捕获模式按调度结果更新采集间隔
+        m_timer->setInterval(m_lane->scheduler.interval());
+        });
+    statsTimer->start(1000);
+
+    // 状态栏显示图片识别结果缓存的命中情况
+    auto cacheLabel = new QLabel(this);
+    ui.statusBar->addPermanentWidget(cacheLabel);
+    connect(statsTimer, &QTimer::timeout, this, [=] {
+        cacheLabel->setText(tr("缓存命中: %1 (磁盘 %2)  未命中: %3")
+            .arg(m_cache.hits() + m_cache.diskHits()).arg(m_cache.diskHits()).arg(m_cache.misses()));
+        });
 
     // 菜单->关闭
     connect(ui.action_quit, &QAction::triggered, this, &QMainWindow::close);
@@ -118,25 +393,96 @@ QRCodeScanner::QRCodeScanner(QWidget *parent)
 
     // 开始按钮
     connect(ui.startBtn, &QPushButton::clicked, this, [=] {
+#ifdef HAVE_V4L2
+        if (ui.v4l2Box->isChecked())
+        {
+            // 相机ID不是设备路径时使用默认设备
+            auto device = ui.cameraComBox->currentData().toString();
+            if (!device.startsWith("/dev/"))
+                device = "/dev/video0";
+            if (!m_v4l2->start(device, [=](const std::shared_ptr<const ZXing::ImageView> &frame) {
+                submitRawFrame(m_lane, frame);
+                }))
+            {
+                ui.statusBar->showMessage(tr("无法打开%1：%2").arg(device, m_v4l2->errorString()));
+                return;
+            }
+            onBackendStarted(tr("正在捕捉 (V4L2 %1)").arg(m_v4l2->formatName()));
+            return;
+        }
+#endif // HAVE_V4L2
+#ifdef HAVE_OPENCV
+        if (ui.opencvBox->isChecked())
+        {
+            // 相机ID是设备路径时按路径打开，否则按列表中的序号打开
+            auto device = ui.cameraComBox->currentData().toString();
+            if (!device.startsWith("/dev/"))
+                device.clear();
+            if (!m_opencv->openCamera(device, ui.cameraComBox->currentIndex(), [=](const std::shared_ptr<const ZXing::ImageView> &frame) {
+                submitRawFrame(m_lane, frame);
+                }))
+            {
+                ui.statusBar->showMessage(tr("无法打开相机：%1").arg(m_opencv->errorString()));
+                return;
+            }
+            onBackendStarted(tr("正在捕捉 (OpenCV)"));
+            return;
+        }
+#endif // HAVE_OPENCV
         ui.stackedWidget->setCurrentIndex(0);
         m_camera->start();
         ui.startBtn->setEnabled(false);
         ui.stopBtn->setEnabled(true);
+        ui.streamModeBox->setEnabled(false);
+        ui.multiCameraBox->setEnabled(false);
         ui.statusBar->showMessage(tr("正在捕捉"));
-        m_timer->start();
+        m_lane->reset();
+        m_duplicates.clear();
+        // 视频流模式按帧识别，否则定时捕获图像
+        if (ui.streamModeBox->isChecked())
+            m_streaming = true;
+        else
+            m_timer->start();
+        // 附加相机均使用视频流识别
+        if (ui.multiCameraBox->isChecked())
+            openExtraCameras();
         });
     // 停止按钮
     connect(ui.stopBtn, &QPushButton::clicked, this, [=] {
+        m_streaming = false;
         m_timer->stop();
         m_camera->stop();
+#ifdef HAVE_V4L2
+        m_v4l2->stop();
+#endif // HAVE_V4L2
+#ifdef HAVE_OPENCV
+        m_opencv->stop();
+#endif // HAVE_OPENCV
+        ui.v4l2Box->setEnabled(true);
+        ui.opencvBox->setEnabled(true);
+        m_lane->mailbox.clear();
+        closeExtraCameras();
         ui.stopBtn->setEnabled(false);
         ui.startBtn->setEnabled(true);
+        ui.streamModeBox->setEnabled(true);
+        ui.multiCameraBox->setEnabled(true);
         ui.statusBar->showMessage(tr("已停止"));
         });
 }
 
 QRCodeScanner::~QRCodeScanner()
 {
+    // 等待识别任务结束，任务中会访问本对象
+#ifdef HAVE_V4L2
+    m_v4l2->stop();
+#endif // HAVE_V4L2
+#ifdef HAVE_OPENCV
+    m_opencv->stop();
+#endif // HAVE_OPENCV
+    for (auto &lane : m_pool.lanes())
+        lane->mailbox.clear();
+    m_executor.waitForDone();
+
     if (m_qrgWidget)
         m_qrgWidget->deleteLater();
 }
@@ -176,79 +522,445 @@ void QRCodeScanner::recognImage(int id, const QImage & img)
     if (img.isNull())
         return;
 
+    ScanFrame scan { id, img, QVideoFrame() };
+    scan.stamp(settings()->frameDeadline);
+    m_lane->mailbox.post(std::move(scan));
+    dispatchFrames();
+}
+
+void QRCodeScanner::recognFrame(const QVideoFrame &frame)
+{
+    if (!m_streaming)
+        return;
+
+    submitFrame(m_lane, frame);
+}
+
+// 视频帧投递到对应相机的识别通道
+void QRCodeScanner::submitFrame(const std::shared_ptr<ScanLane> &lane, const QVideoFrame &frame)
+{
+    if (!frame.isValid())
+        return;
+    // 按调度间隔抽取视频帧，控制识别的CPU占用
+    if (!lane->scheduler.accept())
+        return;
+
+    ScanFrame scan { 0, QImage(), frame };
+    scan.stamp(settings()->frameDeadline);
+    lane->mailbox.post(std::move(scan));
+    dispatchFrames();
+}
+
+// 采集后端的帧投递到对应相机的识别通道，在采集线程中调用；未投递或被丢弃的帧立即归还缓冲区
+void QRCodeScanner::submitRawFrame(const std::shared_ptr<ScanLane> &lane, const std::shared_ptr<const ZXing::ImageView> &frame)
+{
+    if (!lane->scheduler.accept())
+        return;
+
+    ScanFrame scan;
+    scan.raw = frame;
+    scan.stamp(settings()->frameDeadline);
+    lane->mailbox.post(std::move(scan));
+    dispatchFrames();
+}
+
+// 打开的图片文件直接识别，不经信箱丢弃
+void QRCodeScanner::recognFile(const QImage &img)
+{
+    m_executor.start(DecodeExecutor::Batch, [=] {
+        recognTask(nullptr, { 0, img, QVideoFrame(), true });
+        });
+}
+
+// 按轮询顺序从各相机通道取出帧提交识别任务，任务完成后继续取下一帧
+void QRCodeScanner::dispatchFrames()
+{
+    std::shared_ptr<ScanLane> lane;
+    ScanFrame frame;
+    while (m_pool.next(lane, frame))
+    {
+        m_executor.start(DecodeExecutor::Live, [this, lane, frame] {
+            QElapsedTimer elstimer;
+            elstimer.start();
+            auto result = recognTask(lane.get(), frame);
+            // 未实际识别的帧耗时接近0，不计入平均耗时
+            if (result != TaskResult::Skipped)
+                lane->scheduler.addSample(elstimer.elapsed(), result == TaskResult::Found);
+            lane->mailbox.done();
+            m_pool.done();
+            dispatchFrames();
+            });
+    }
+}
+
+// 打开除主相机外的所有相机，各自作为独立的识别通道
+void QRCodeScanner::openExtraCameras()
+{
+#ifndef QT5VER
+    auto primary = ui.cameraComBox->currentData().toByteArray();
+    for (auto &device : QMediaDevices::videoInputs())
+    {
+        if (device.id() == primary)
+            continue;
+
+        auto name = device.description().isEmpty() ? QString::fromUtf8(device.id()) : device.description();
+        auto lane = std::make_shared<ScanLane>(name);
+        lane->scheduler.setCpuBudget(ui.cpuBudgetBox->value() / 100.0);
+        lane->scheduler.setTargetLatency(ui.targetLatencyBox->value());
+
+        // 附加相机不显示预览，帧直接输出到QVideoSink
+        auto camera = new QCamera(device, this);
+        auto session = new QMediaCaptureSession(camera);
+        auto sink = new QVideoSink(camera);
+        session->setCamera(camera);
+        session->setVideoSink(sink);
+        connect(sink, &QVideoSink::videoFrameChanged, this, [=](const QVideoFrame &frame) {
+            submitFrame(lane, frame);
+            });
+        connect(camera, &QCamera::errorOccurred, this, [=] {
+            ui.statusBar->showMessage(tr("相机发生错误：%1").arg(camera->errorString()));
+            });
+
+        lane->camera = camera;
+        m_pool.addLane(lane);
+        camera->start();
+    }
+#endif // QT5VER
+}
+
+void QRCodeScanner::closeExtraCameras()
+{
+    for (auto &lane : m_pool.lanes())
+    {
+        if (lane == m_lane)
+            continue;
+
+        // 识别中的任务仍持有通道，相机对象由GUI线程删除
+        m_pool.removeLane(lane);
+        lane->mailbox.clear();
+        if (lane->camera)
+        {
+            lane->camera->stop();
+            lane->camera->deleteLater();
+        }
+    }
+}
+
+// 根据控件状态构建识别设置并发布，仅在GUI线程调用
+void QRCodeScanner::updateSettings()
+{
     using ZXing::BarcodeFormat;
 
-    auto task = [=] {
-        QElapsedTimer elstimer;
-        elstimer.start();
-
-        ZXing::BarcodeFormats format = BarcodeFormat::None;
-        if (ui.linearCodesBox->isChecked())
-            format |= BarcodeFormat::LinearCodes;
-        if (ui.matrixCodesBox->isChecked())
-            format |= BarcodeFormat::MatrixCodes;
-
-        // ZXing参数
-        auto options = ZXing::ReaderOptions()
-            // 识别的格式，Any = LinearCodes | MatrixCodes
-            .setFormats(format)
-            .setTryHarder(ui.tryHarderBox->isChecked())
-            .setTryRotate(ui.tryRotateBox->isChecked())
-            .setTryInvert(ui.tryInvertBox->isChecked())
-            .setTextMode(ZXing::TextMode::HRI)
-            .setMaxNumberOfSymbols(5);
-
-        QStringList texts;
-        QStringList types;
-        QList<QPolygon> rects;
-
-        try
+    ZXing::BarcodeFormats format = BarcodeFormat::None;
+    if (ui.linearCodesBox->isChecked())
+        format |= BarcodeFormat::LinearCodes;
+    if (ui.matrixCodesBox->isChecked())
+        format |= BarcodeFormat::MatrixCodes;
+
+    auto settings = std::make_shared<ScanSettings>();
+    // ZXing参数
+    settings->options
+        // 识别的格式，Any = LinearCodes | MatrixCodes
+        .setFormats(format)
+        .setTryHarder(ui.tryHarderBox->isChecked())
+        .setTryRotate(ui.tryRotateBox->isChecked())
+        .setTryInvert(ui.tryInvertBox->isChecked())
+        .setTryDenoise(ui.tryDenoiseBox->isChecked())
+        .setTryDownscale(ui.tryDownscaleBox->isChecked())
+        .setDownscaleThreshold(ui.downscaleThresholdBox->value())
+        .setDownscaleFactor(ui.downscaleFactorBox->value())
+        .setTextMode(ZXing::TextMode::HRI)
+        .setMaxNumberOfSymbols(5);
+    settings->cascade = ui.cascadeBox->isChecked();
+    settings->parallel = ui.parallelBox->isChecked();
+    settings->tiled = ui.tiledBox->isChecked();
+    settings->autoDownscale = ui.autoDownscaleBox->isChecked();
+    settings->preprocess = (ui.denoiseBox->isChecked() ? Preprocessor::Denoise : 0)
+        | (ui.contrastBox->isChecked() ? Preprocessor::Contrast : 0)
+        | (ui.sharpenBox->isChecked() ? Preprocessor::Sharpen : 0);
+    settings->preprocessAlways = ui.preprocessAlwaysBox->isChecked();
+    settings->rectify = ui.rectifyBox->isChecked();
+    settings->formatPriority = ui.formatPriorityBox->isChecked();
+    settings->resultCache = ui.resultCacheBox->isChecked();
+    settings->frameDeadline = ui.frameDeadlineBox->value();
+    settings->binarizer = ui.binarizerBox->currentData().toInt();
+    settings->pyramidLevels = ui.pyramidLevelsBox->value();
+    settings->continuous = ui.continuousBox->isChecked();
+    settings->tracking = ui.trackingBox->isChecked();
+    settings->trackingInterval = ui.trackingIntervalBox->value();
+    settings->trackingMargin = ui.trackingMarginBox->value();
+    settings->changeGate = ui.changeGateBox->isChecked();
+
+    QMutexLocker locker(&m_settingsMutex);
+    m_settings = std::move(settings);
+}
+
+// 获取当前识别设置快照，可在任意线程调用
+ScanSettingsPtr QRCodeScanner::settings() const
+{
+    QMutexLocker locker(&m_settingsMutex);
+    return m_settings;
+}
+
+// 识别任务，在线程池中运行；视频帧有效时识别视频帧，否则识别图像，返回是否实际识别及是否识别到结果
+// lane为帧所属的相机通道，图片文件为空
+QRCodeScanner::TaskResult QRCodeScanner::recognTask(ScanLane *lane, const ScanFrame &frame)
+{
+    QElapsedTimer elstimer;
+    elstimer.start();
+
+    auto settings = this->settings();
+    auto &options = settings->options;
+    auto &img = frame.image;
+
+    // 连续扫描的相机帧只上报新出现的条码，且不切换到图片显示
+    bool continuous = settings->continuous && !frame.file;
+    bool found = false;
+
+    QStringList texts;
+    QStringList types;
+    QList<QPolygon> rects;
+
+    // 相机帧启用区域跟踪时，只识别上次条码位置附近的区域
+    bool tracking = lane && settings->tracking;
+    bool gated = lane && settings->changeGate;
+    QList<QPolygon> hits;
+
+    // 等待期间已超过截止时间的相机帧不再识别
+    if (lane && frame.deadline.hasExpired())
+    {
+        lane->mailbox.abandon();
+        return TaskResult::Skipped;
+    }
+
+    try
+    {
+        // 视频帧直接映射内存识别
+        FrameView view(frame);
+        if (!view.isValid())
+            return TaskResult::Skipped;
+
+        // 画面与上一次未识别到结果的帧基本相同时跳过
+        if (gated && lane->gate.skip(view.view()))
+            return TaskResult::Skipped;
+
+        QRect roi = tracking ? lane->tracker.region(QSize(view.width(), view.height()), settings->trackingInterval) : QRect();
+        auto image = roi.isNull() ? view.view() : view.view().cropped(roi.x(), roi.y(), roi.width(), roi.height());
+
+        // 相机帧优先只识别本次运行中最常见的格式，图片文件始终识别全部格式
+        auto frameOptions = ZXing::ReaderOptions(options);
+        if (settings->formatPriority && !frame.file)
+            frameOptions.setFormats(m_formats.formats(options.formats()));
+
+        // 二值化算法：手动指定，或由相机通道采样后自动选择
+        bool tuning = lane && settings->binarizer < 0;
+        auto binarizer = options.binarizer();
+        if (settings->binarizer >= 0)
+            binarizer = static_cast<ZXing::Binarizer>(settings->binarizer);
+        else if (tuning)
+            binarizer = lane->binarizer.select();
+        frameOptions.setBinarizer(binarizer);
+
+        // 缩小识别参数：相机帧根据帧尺寸与近期条码尺寸自动选择
+        if (lane && settings->autoDownscale && options.tryDownscale())
+        {
+            auto profile = lane->downscale.profile(image.width(), image.height(),
+                { true, options.downscaleThreshold(), options.downscaleFactor() });
+            frameOptions.setTryDownscale(profile.enabled)
+                .setDownscaleThreshold(profile.threshold)
+                .setDownscaleFactor(profile.factor);
+        }
+
+        // 透视校正使用常规识别中已定位但未能解码的条码，不再单独检测
+        if (settings->rectify)
+            frameOptions.setReturnErrors(true);
+
+        // 调用ZXing接口
+        // 任务内部的并行识别使用任务所在的线程池
+        auto pool = m_executor.pool(frame.file ? DecodeExecutor::Batch : DecodeExecutor::Live);
+        auto decodeRaw = [&](const ZXing::ImageView &view, const ZXing::ReaderOptions &opts) {
+            if (settings->cascade)
+                return m_cascade.decode(view, opts, settings->parallel, pool, frame.deadline);
+            if (settings->parallel)
+                return VariantDecoder::decode(view, opts, pool, frame.deadline);
+            return ZXing::ReadBarcodes(view, opts);
+            };
+
+        // 预处理：总是预处理，或原图未识别到且未超过截止时间时，滤波后再识别一次
+        // 分块识别时多个线程同时预处理，耗时原子累加
+        auto &preprocessor = lane ? lane->preprocess : m_preprocess;
+        std::atomic<qint64> preprocessTime { 0 };
+        std::atomic<bool> preprocessed { false };
+        auto decodeWith = [&](const ZXing::ImageView &view, const ZXing::ReaderOptions &opts) {
+            if (!settings->preprocess)
+                return decodeRaw(view, opts);
+            ZXing::Barcodes unfiltered;
+            if (!settings->preprocessAlways)
+            {
+                unfiltered = decodeRaw(view, opts);
+                if (HasValidResult(unfiltered) || frame.deadline.hasExpired())
+                    return unfiltered;
+            }
+            QElapsedTimer timer;
+            timer.start();
+            auto buffer = BufferPool::local().acquire(static_cast<size_t>(view.width()) * view.height());
+            auto filtered = Preprocessor::apply(view, settings->preprocess, buffer.storage());
+            preprocessTime += timer.nsecsElapsed();
+            preprocessed = true;
+            auto results = decodeRaw(filtered, opts);
+            // 预处理后仍未定位到条码时保留原图中定位到的条码
+            return results.empty() ? unfiltered : results;
+            };
+
+        // 多尺度识别由小到大依次识别各尺度，取代ZXing内部的缩小识别
+        auto levelOptions = ZXing::ReaderOptions(frameOptions).setTryDownscale(false);
+        auto decodeView = [&](const ZXing::ImageView &view) {
+            if (settings->pyramidLevels > 1)
+            {
+                return m_pyramid.decode(view, settings->pyramidLevels, [&](const ZXing::ImageView &level) {
+                    return decodeWith(level, levelOptions);
+                    }, frame.deadline);
+            }
+            return decodeWith(view, frameOptions);
+            };
+
+        // 图片文件先查找识别结果缓存，键包含影响结果的识别方式
+        QByteArray cacheKey;
+        ResultCache::Entry cached;
+        if (frame.file && settings->resultCache)
         {
-            // 调用ZXing接口
-            auto results = ZXingQt::ReadBarcodes(img, options);
+            quint32 extra = (settings->tiled ? 1 : 0) | (settings->cascade ? 2 : 0) | settings->pyramidLevels << 2
+                | settings->preprocess << 5 | (settings->preprocessAlways ? 1 : 0) << 8
+                | (settings->rectify ? 1 : 0) << 9 | (settings->parallel ? 1 : 0) << 10;
+            cacheKey = ResultCache::key(image, frameOptions, extra);
+        }
+        bool cacheHit = !cacheKey.isEmpty() && m_cache.find(cacheKey, cached);
+
+        ZXing::Barcodes results;
+        ZXing::Barcodes parts;
+        if (!cacheHit)
+        {
+            QElapsedTimer decodeTimer;
+            decodeTimer.start();
+            // 超大图片文件分块并行识别
+            if (frame.file && settings->tiled && TiledDecoder::shouldTile(image))
+                results = TiledDecoder::decode(image, decodeView, 2048, 256, pool);
+            else
+                results = decodeView(image);
+            auto failed = TakeInvalidResults(results);
+            if (tuning)
+                lane->binarizer.record(binarizer, !results.empty(), decodeTimer.nsecsElapsed() / 1e6);
+            if (preprocessed)
+                preprocessor.record(preprocessTime / 1e6, !results.empty());
+            // 倾斜严重时定位成功但解码失败，校正已定位的区域后按纯净图像再识别
+            if (results.empty() && !failed.empty() && !frame.deadline.hasExpired())
+                results = m_rectify.decode(image, failed, frameOptions, frame.deadline);
+        }
 
-            for (auto &result : results)
+        found = !results.empty();
+
+        for (auto &result : results)
+        {
+            // 区域坐标转换为整帧坐标
+            auto &pos = result.position();
+            QPolygon polygon;
+            for (auto &p : pos)
+                polygon.append(QPoint(p.x, p.y) + roi.topLeft());
+            hits += polygon;
+            if (lane)
             {
-                auto &pos = result.position();
-                QPolygon polygon;
-                polygon.append(pos[0]);
-                polygon.append(pos[1]);
-                polygon.append(pos[2]);
-                polygon.append(pos[3]);
+                auto box = polygon.boundingRect();
+                lane->downscale.record(qMin(box.width(), box.height()));
+            }
+            m_formats.record(result.format());
+            if (result.isPartOfSequence())
+                parts.push_back(result);
+
+            auto text = QString::fromStdString(result.text());
+            if (continuous && !m_duplicates.accept(text, static_cast<int>(result.format())))
+                continue;
 
 #ifdef QT_DEBUG
-                qDebug() << "Text:    " << result.text();
-                qDebug() << "Format:  " << ZXing::ToString(result.format());
-                qDebug() << "Content: " << ZXing::ToString(result.contentType());
-                qDebug() << "Position:" << polygon << Qt::endl;
+            qDebug() << "Text:    " << text;
+            qDebug() << "Format:  " << QString::fromStdString(ZXing::ToString(result.format()));
+            qDebug() << "Content: " << QString::fromStdString(ZXing::ToString(result.contentType()));
+            qDebug() << "Position:" << polygon << Qt::endl;
 #endif // QT_DEBUG
 
-                // 保存结果
-                texts.append(result.text());
-                types.append(QString::fromStdString(ZXing::ToString(result.format())));
-                rects += polygon;
-            }
+            // 保存结果
+            texts.append(text);
+            types.append(QString::fromStdString(ZXing::ToString(result.format())));
+            rects += polygon;
         }
-        catch (const std::exception &e)
+
+        // 结构化追加的各部分跨帧收集，到齐后追加合并后的完整内容
+        for (auto &merged : m_sequences.add(parts))
         {
-            qWarning() << "识别失败:" << e.what();
+            auto text = QString::fromStdString(merged.text());
+            if (continuous && !m_duplicates.accept(text, static_cast<int>(merged.format())))
+                continue;
+            texts.append(text);
+            types.append(tr("%1 结构化追加合并").arg(QString::fromStdString(ZXing::ToString(merged.format()))));
         }
 
-        if (!texts.isEmpty())
+        if (cacheHit)
         {
-            // 发送已识别信号
-            emit recognSuccess(texts, types);
-            emit recognOutline(img, rects);
+            texts = cached.texts;
+            types = cached.types;
+            rects = cached.rects;
+            found = !texts.isEmpty();
         }
-        else if (ui.stackedWidget->currentIndex() == 1)
+        else if (!cacheKey.isEmpty() && parts.empty())
         {
-            emit recognFailed();
+            // 含结构化追加部分的图片不缓存，重新打开时仍参与拼接
+            m_cache.insert(cacheKey, { texts, types, rects });
         }
 
-        qDebug() << "time:" << elstimer.elapsed();
-        };
-    // 运行识别任务
-    QThreadPool::globalInstance()->start(task);
+        if (tracking)
+            lane->tracker.update(hits, settings->trackingMargin / 100.0);
+        // 只识别了跟踪区域时不能说明整帧无条码，不作为无变化画面的参考
+        if (gated)
+            lane->gate.update(found || !roi.isNull());
+    }
+    catch (const std::exception &e)
+    {
+        qWarning() << "识别失败:" << e.what();
+    }
+
+    // 更新的帧已完成识别时，本帧的结果已过期，不再发送
+    if (lane && !lane->mailbox.complete(frame.captured))
+    {
+        lane->mailbox.abandon();
+        return found ? TaskResult::Found : TaskResult::NotFound;
+    }
+
+    if (!texts.isEmpty())
+    {
+        // 发送已识别信号，多相机时标明来源
+        QString source = lane && m_pool.laneCount() > 1 ? lane->name : QString();
+        emit recognSuccess(texts, types, source);
+        if (!continuous)
+        {
+            // 视频帧仅在识别成功时转换为图像用于标记
+            auto outline = img;
+            if (frame.raw)
+                outline = FrameView::toImage(*frame.raw).convertToFormat(QImage::Format_RGB32);
+            else if (outline.isNull())
+#ifdef QT5VER
+                outline = frame.frame.image();
+#else
+                outline = frame.frame.toImage();
+#endif // QT5VER
+            emit recognOutline(outline, rects);
+        }
+    }
+    else if (frame.file)
+    {
+        emit recognFailed();
+    }
+
+    qDebug() << "time:" << elstimer.elapsed();
+    return found ? TaskResult::Found : TaskResult::NotFound;
 }
 
 void QRCodeScanner::saveResultToFile()
@@ -311,8 +1023,47 @@ void QRCodeScanner::openImageFile()
         }
         m_viewer->setImage(img);
         ui.stackedWidget->setCurrentIndex(1);
-        recognImage(0, img);
+        recognFile(img);
+    }
+}
+
+// 回放视频文件或图片序列，按原帧率投递到主相机通道，重现相机的识别过程
+void QRCodeScanner::openVideoFile()
+{
+#ifdef HAVE_OPENCV
+    if (ui.stopBtn->isEnabled())
+        ui.stopBtn->click();
+
+    auto path = QStandardPaths::writableLocation(QStandardPaths::MoviesLocation);
+    auto fileName = QFileDialog::getOpenFileName(this, tr("选择视频或图片序列的第一张图片"), path,
+        "视频 (*.mp4 *.avi *.mkv *.mov);; 图片序列 (*.png *.jpg *.jpeg *.bmp *.tif *.tiff *.webp);; 所有文件 (*.*)");
+    if (fileName.isEmpty())
+        return;
+
+    if (!m_opencv->openFile(fileName, [=](const std::shared_ptr<const ZXing::ImageView> &frame) {
+        submitRawFrame(m_lane, frame);
+        }))
+    {
+        QMessageBox::critical(this, tr("错误"), tr("无法打开：%1").arg(fileName));
+        return;
     }
+    onBackendStarted(tr("正在回放 %1").arg(QFileInfo(fileName).fileName()));
+#endif // HAVE_OPENCV
+}
+
+// 采集后端开始采集后更新界面状态，预览显示采集后端定时发送的灰度图像
+void QRCodeScanner::onBackendStarted(const QString &message)
+{
+    ui.stackedWidget->setCurrentIndex(1);
+    ui.startBtn->setEnabled(false);
+    ui.stopBtn->setEnabled(true);
+    ui.streamModeBox->setEnabled(false);
+    ui.multiCameraBox->setEnabled(false);
+    ui.v4l2Box->setEnabled(false);
+    ui.opencvBox->setEnabled(false);
+    ui.statusBar->showMessage(message);
+    m_lane->reset();
+    m_duplicates.clear();
 }
 
 // 相机选择
@@ -385,13 +1136,18 @@ void QRCodeScanner::onCameraErrorOccurred()
     ui.statusBar->showMessage(tr("相机发生错误"));
 }
 
-void QRCodeScanner::onResultsRecieved(const QStringList & texts, const QStringList & types)
+void QRCodeScanner::onResultsRecieved(const QStringList & texts, const QStringList & types, const QString &source)
 {
-    ui.stopBtn->click();
+    // 连续扫描时保持相机与识别运行
+    if (!ui.continuousBox->isChecked())
+        ui.stopBtn->click();
     for (int i = 0; i < texts.size(); i++)
     {
         ui.historyBrowser->setTextColor(Qt::gray);
-        ui.historyBrowser->append(QString("[%1/%2 %3]").arg(i + 1).arg(texts.size()).arg(types[i]));
+        if (source.isEmpty())
+            ui.historyBrowser->append(QString("[%1/%2 %3]").arg(i + 1).arg(texts.size()).arg(types[i]));
+        else
+            ui.historyBrowser->append(QString("[%1/%2 %3 %4]").arg(i + 1).arg(texts.size()).arg(types[i]).arg(source));
         ui.historyBrowser->setTextColor(Qt::black);
         ui.historyBrowser->append(texts[i]);
     }
@@ -401,7 +1157,9 @@ void QRCodeScanner::onResultsRecieved(const QStringList & texts, const QStringLi
 
 void QRCodeScanner::onResultsOutline(const QImage & img, const QList<QPolygon> &rects) const
 {
-    QImage rsimg = img;
+    // 调色板图像不能直接绘制，先转换为32位图像
+    QImage rsimg = img.colorCount() > 0 ? img.convertToFormat(QImage::Format_RGB32) : img;
+
     QPainter p(&rsimg);
     p.setRenderHint(QPainter::Antialiasing);
 
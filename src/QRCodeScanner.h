@@ -3,11 +3,26 @@
 #include <QtWidgets/QMainWindow>
 #include "ui_QRCodeScanner.h"
 #include <QTimer>
+#include <QMutex>
+#include "DecodeCascade.h"
+#include "DecodeExecutor.h"
+#include "DecodePool.h"
+#include "DuplicateFilter.h"
+#include "FormatPriority.h"
+#include "Preprocessor.h"
+#include "PyramidDecoder.h"
+#include "RectifyDecoder.h"
+#include "ResultCache.h"
+#include "ScanLane.h"
+#include "ScanSettings.h"
+#include "SequenceAssembler.h"
 
 class QCamera;
 class QVideoWidget;
 class QRCodeGenerator;
 class ImageView;
+class V4l2Capture;
+class OpenCvCapture;
 
 class QRCodeScanner : public QMainWindow
 {
@@ -18,23 +33,39 @@ public:
     ~QRCodeScanner();
 
 signals:
-    void recognSuccess(const QStringList &texts, const QStringList &types);
+    void recognSuccess(const QStringList &texts, const QStringList &types, const QString &source);
     void recognOutline(const QImage &img, const QList<QPolygon> &rects);
     void recognFailed();
 
 public slots:
     void freshCameras();
     void recognImage(int id, const QImage &img);
+    void recognFrame(const QVideoFrame &frame);
     void saveResultToFile();
     void openQRGeneratorWidget();
     void openImageFile();
+    void openVideoFile();
 
 protected slots:
     void onCameraIndexChanged(int index);
     void onCameraErrorOccurred();
-    void onResultsRecieved(const QStringList &texts, const QStringList &types);
+    void onResultsRecieved(const QStringList &texts, const QStringList &types, const QString &source);
     void onResultsOutline(const QImage &img, const QList<QPolygon> &rects) const;
 
+private:
+    void recognFile(const QImage &img);
+    void submitFrame(const std::shared_ptr<ScanLane> &lane, const QVideoFrame &frame);
+    void submitRawFrame(const std::shared_ptr<ScanLane> &lane, const std::shared_ptr<const ZXing::ImageView> &frame);
+    void dispatchFrames();
+    void onBackendStarted(const QString &message);
+    // 识别任务的结果，Skipped为未实际识别的帧(超过截止时间、画面无变化或帧无效)
+    enum class TaskResult { Skipped, NotFound, Found };
+    TaskResult recognTask(ScanLane *lane, const ScanFrame &frame);
+    void openExtraCameras();
+    void closeExtraCameras();
+    void updateSettings();
+    ScanSettingsPtr settings() const;
+
 private:
     Ui::QRCodeScannerClass ui;
     QCamera *m_camera = nullptr;
@@ -42,4 +73,20 @@ private:
     QTimer *m_timer = nullptr;
     QRCodeGenerator *m_qrgWidget = nullptr;
     ImageView *m_viewer = nullptr;
+    bool m_streaming = false;   // 视频流模式是否正在采集
+    V4l2Capture *m_v4l2 = nullptr;  // V4L2直接采集，仅Linux可用
+    OpenCvCapture *m_opencv = nullptr;  // OpenCV采集与回放，仅找到OpenCV时可用
+    std::shared_ptr<ScanLane> m_lane;   // 主相机识别通道
+    DecodeExecutor m_executor;  // 识别专用线程池
+    DecodePool m_pool;          // 各相机通道共享的识别调度
+    DuplicateFilter m_duplicates;   // 连续扫描重复结果抑制
+    DecodeCascade m_cascade;    // 分级识别
+    PyramidDecoder m_pyramid;   // 多尺度识别
+    RectifyDecoder m_rectify;   // 透视校正重试
+    Preprocessor m_preprocess;  // 图片文件的预处理统计
+    FormatPriority m_formats;   // 常见格式优先识别
+    ResultCache m_cache;        // 图片识别结果缓存
+    SequenceAssembler m_sequences;  // 结构化追加跨帧拼接
+    mutable QMutex m_settingsMutex;
+    ScanSettingsPtr m_settings; // 当前识别设置
 };
@@ -0,0 +1,298 @@
+#include "RectifyDecoder.h"
+#include "BufferPool.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RECTIFY_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define RECTIFY_NEON
+#endif
+
+using ZXing::ImageFormat;
+
+namespace {
+
+// 透视变换无效的像素与静区相同，填充为白色
+constexpr uint8_t Fill = 255;
+
+double EdgeLength(ZXing::PointI p, ZXing::PointI q)
+{
+    return std::hypot(double(p.x - q.x), double(p.y - q.y));
+}
+
+// 四边形面积(鞋带公式)
+double Area(const ZXing::QuadrilateralI &quad)
+{
+    double sum = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        auto &p = quad[i];
+        auto &q = quad[(i + 1) % 4];
+        sum += double(p.x) * q.y - double(q.x) * p.y;
+    }
+    return std::abs(sum) / 2;
+}
+
+} // namespace
+
+bool RectifyDecoder::Homography::fromQuad(const ZXing::QuadrilateralI &quad)
+{
+    const double x0 = quad[0].x, y0 = quad[0].y, x1 = quad[1].x, y1 = quad[1].y;
+    const double x2 = quad[2].x, y2 = quad[2].y, x3 = quad[3].x, y3 = quad[3].y;
+    const double dx1 = x1 - x2, dx2 = x3 - x2, dx3 = x0 - x1 + x2 - x3;
+    const double dy1 = y1 - y2, dy2 = y3 - y2, dy3 = y0 - y1 + y2 - y3;
+
+    if (dx3 == 0 && dy3 == 0)
+    {
+        // 平行四边形为仿射变换
+        g = h = 0;
+    }
+    else
+    {
+        const double den = dx1 * dy2 - dx2 * dy1;
+        if (std::abs(den) < 1e-9)
+            return false;
+        g = (dx3 * dy2 - dx2 * dy3) / den;
+        h = (dx1 * dy3 - dx3 * dy1) / den;
+    }
+    a = x1 - x0 + g * x1;
+    b = x3 - x0 + h * x3;
+    c = x0;
+    d = y1 - y0 + g * y1;
+    e = y3 - y0 + h * y3;
+    f = y0;
+    return true;
+}
+
+ZXing::PointF RectifyDecoder::Homography::map(double u, double v) const
+{
+    const double w = g * u + h * v + 1;
+    return { (a * u + b * v + c) / w, (d * u + e * v + f) / w };
+}
+
+ZXing::Barcodes RectifyDecoder::decode(const ZXing::ImageView &image, const ZXing::Barcodes &candidates,
+    const ZXing::ReaderOptions &options, QDeadlineTimer deadline)
+{
+    if (image.width() < 2 || image.height() < 2)
+        return {};
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 只有二维码可按纯净图像识别
+    const ZXing::BarcodeFormats matrix = ZXing::BarcodeFormat::MatrixCodes;
+    ZXing::Barcodes results;
+    int count = 0;
+    for (auto &candidate : candidates)
+    {
+        if (candidate.isValid() || !matrix.testFlag(candidate.format()))
+            continue;
+        if (count >= MaxCandidates || (count > 0 && deadline.hasExpired()))
+            break;
+
+        auto &quad = candidate.position();
+        double longest = 0;
+        for (int i = 0; i < 4; i++)
+            longest = std::max(longest, EdgeLength(quad[i], quad[(i + 1) % 4]));
+        Homography homography;
+        if (Area(quad) < MinSide * MinSide / 4 || !homography.fromQuad(quad))
+            continue;
+        count++;
+
+        // 条码区域缩放到最长边的尺寸，四周保留静区
+        const int side = qBound(MinSide, qRound(longest), MaxSide);
+        const int margin = side / 8 + 2;
+        const int size = side + 2 * margin;
+        auto buffer = BufferPool::local().acquire(static_cast<size_t>(size) * size);
+        auto rectified = warp(image, homography, side, margin, buffer.storage());
+
+        auto pure = ZXing::ReaderOptions(options)
+            .setFormats(candidate.format())
+            .setTryHarder(false)
+            .setTryRotate(false)
+            .setTryDownscale(false)
+            .setReturnErrors(false)
+            .setIsPure(true);
+        auto found = ZXing::ReadBarcodes(rectified, pure);
+        // 校正后仍有残余形变时按普通图像再识别一次，校正图像很小，代价可以忽略
+        if (found.empty())
+            found = ZXing::ReadBarcodes(rectified, pure.setIsPure(false));
+
+        // 校正图像坐标转换为原图坐标
+        for (auto &result : found)
+        {
+            auto pos = result.position();
+            for (auto &p : pos)
+            {
+                auto src = homography.map((p.x + 0.5 - margin) / side, (p.y + 0.5 - margin) / side);
+                p = { static_cast<int>(std::lround(src.x - 0.5)), static_cast<int>(std::lround(src.y - 0.5)) };
+            }
+            result.setPosition(pos);
+            results.push_back(std::move(result));
+        }
+    }
+
+    if (count > 0)
+        record(count, !results.empty(), timer.nsecsElapsed() / 1e6);
+    return results;
+}
+
+ZXing::ImageView RectifyDecoder::warp(const ZXing::ImageView &image, const Homography &H, int side, int margin,
+    std::vector<uint8_t> &buffer)
+{
+    const int size = side + 2 * margin;
+    buffer.resize(static_cast<size_t>(size) * size);
+
+    const int ps = image.pixStride();
+    const int rs = image.rowStride();
+    const auto fmt = image.format();
+    const bool lum = fmt == ImageFormat::Lum || fmt == ImageFormat::LumA;
+    const int ri = ZXing::RedIndex(fmt), gi = ZXing::GreenIndex(fmt), bi = ZXing::BlueIndex(fmt);
+    const uint8_t *base = image.data(0, 0);
+    // 采样坐标限制在图像内，右下相邻像素总是有效
+    const float maxX = image.width() - 1.001f;
+    const float maxY = image.height() - 1.001f;
+
+    auto pixel = [&](int x, int y) -> float {
+        const uint8_t *p = base + static_cast<ptrdiff_t>(y) * rs + static_cast<ptrdiff_t>(x) * ps;
+        return lum ? p[0] : ZXing::RGBToLum(p[ri], p[gi], p[bi]);
+    };
+    auto bilinear = [&](float sx, float sy) -> uint8_t {
+        sx = std::clamp(sx, 0.0f, maxX);
+        sy = std::clamp(sy, 0.0f, maxY);
+        const int x = static_cast<int>(sx), y = static_cast<int>(sy);
+        const float fx = sx - x, fy = sy - y;
+        const float top = pixel(x, y) + (pixel(x + 1, y) - pixel(x, y)) * fx;
+        const float bottom = pixel(x, y + 1) + (pixel(x + 1, y + 1) - pixel(x, y + 1)) * fx;
+        return static_cast<uint8_t>(top + (bottom - top) * fy + 0.5f);
+    };
+
+    // 输出像素中心(i+0.5, j+0.5)对应单位正方形坐标u、v，分子分母均随i线性变化
+    const double step = 1.0 / side;
+    const double u0 = (0.5 - margin) * step;
+    const float dX = static_cast<float>(H.a * step), dY = static_cast<float>(H.d * step), dW = static_cast<float>(H.g * step);
+
+    for (int j = 0; j < size; j++)
+    {
+        const double v = (j + 0.5 - margin) * step;
+        const float X0 = static_cast<float>(H.a * u0 + H.b * v + H.c);
+        const float Y0 = static_cast<float>(H.d * u0 + H.e * v + H.f);
+        const float W0 = static_cast<float>(H.g * u0 + H.h * v + 1);
+        uint8_t *dst = buffer.data() + static_cast<size_t>(j) * size;
+
+        int i = 0;
+#if defined(RECTIFY_SSE2) || defined(RECTIFY_NEON)
+        // 坐标计算与插值使用向量运算，四个相邻像素逐个读取
+        alignas(16) int32_t ix[4], iy[4];
+        alignas(16) float p00[4], p01[4], p10[4], p11[4];
+        auto gather = [&] {
+            for (int k = 0; k < 4; k++)
+            {
+                p00[k] = pixel(ix[k], iy[k]);
+                p01[k] = pixel(ix[k] + 1, iy[k]);
+                p10[k] = pixel(ix[k], iy[k] + 1);
+                p11[k] = pixel(ix[k] + 1, iy[k] + 1);
+            }
+            };
+#endif
+#if defined(RECTIFY_SSE2)
+        const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 zero = _mm_setzero_ps();
+        for (; i + 4 <= size; i += 4)
+        {
+            __m128 fi = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lanes);
+            __m128 X = _mm_add_ps(_mm_set1_ps(X0), _mm_mul_ps(fi, _mm_set1_ps(dX)));
+            __m128 Y = _mm_add_ps(_mm_set1_ps(Y0), _mm_mul_ps(fi, _mm_set1_ps(dY)));
+            __m128 W = _mm_add_ps(_mm_set1_ps(W0), _mm_mul_ps(fi, _mm_set1_ps(dW)));
+            __m128 sx = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_div_ps(X, W), half), zero), _mm_set1_ps(maxX));
+            __m128 sy = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_div_ps(Y, W), half), zero), _mm_set1_ps(maxY));
+            __m128i vx = _mm_cvttps_epi32(sx);
+            __m128i vy = _mm_cvttps_epi32(sy);
+            __m128 fx = _mm_sub_ps(sx, _mm_cvtepi32_ps(vx));
+            __m128 fy = _mm_sub_ps(sy, _mm_cvtepi32_ps(vy));
+            _mm_store_si128(reinterpret_cast<__m128i *>(ix), vx);
+            _mm_store_si128(reinterpret_cast<__m128i *>(iy), vy);
+            gather();
+            __m128 a = _mm_load_ps(p00), b = _mm_load_ps(p01), c = _mm_load_ps(p10), d = _mm_load_ps(p11);
+            __m128 top = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), fx));
+            __m128 bottom = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(d, c), fx));
+            __m128 value = _mm_add_ps(_mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), fy)), half);
+            // 分母不为正的像素位于视平线另一侧，坐标已被钳位，改为填充值
+            __m128 valid = _mm_cmpgt_ps(W, zero);
+            value = _mm_or_ps(_mm_and_ps(valid, value), _mm_andnot_ps(valid, _mm_set1_ps(Fill)));
+            __m128i packed = _mm_cvttps_epi32(value);
+            packed = _mm_packs_epi32(packed, packed);
+            packed = _mm_packus_epi16(packed, packed);
+            int32_t out = _mm_cvtsi128_si32(packed);
+            std::memcpy(dst + i, &out, 4);
+        }
+#elif defined(RECTIFY_NEON)
+        const float32x4_t lanes = { 0.0f, 1.0f, 2.0f, 3.0f };
+        const float32x4_t half = vdupq_n_f32(0.5f);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        for (; i + 4 <= size; i += 4)
+        {
+            float32x4_t fi = vaddq_f32(vdupq_n_f32(static_cast<float>(i)), lanes);
+            float32x4_t X = vmlaq_n_f32(vdupq_n_f32(X0), fi, dX);
+            float32x4_t Y = vmlaq_n_f32(vdupq_n_f32(Y0), fi, dY);
+            float32x4_t W = vmlaq_n_f32(vdupq_n_f32(W0), fi, dW);
+            // 倒数估计加两次牛顿迭代代替除法
+            float32x4_t r = vrecpeq_f32(W);
+            r = vmulq_f32(vrecpsq_f32(W, r), r);
+            r = vmulq_f32(vrecpsq_f32(W, r), r);
+            float32x4_t sx = vminq_f32(vmaxq_f32(vsubq_f32(vmulq_f32(X, r), half), zero), vdupq_n_f32(maxX));
+            float32x4_t sy = vminq_f32(vmaxq_f32(vsubq_f32(vmulq_f32(Y, r), half), zero), vdupq_n_f32(maxY));
+            int32x4_t vx = vcvtq_s32_f32(sx);
+            int32x4_t vy = vcvtq_s32_f32(sy);
+            float32x4_t fx = vsubq_f32(sx, vcvtq_f32_s32(vx));
+            float32x4_t fy = vsubq_f32(sy, vcvtq_f32_s32(vy));
+            vst1q_s32(ix, vx);
+            vst1q_s32(iy, vy);
+            gather();
+            float32x4_t a = vld1q_f32(p00), b = vld1q_f32(p01), c = vld1q_f32(p10), d = vld1q_f32(p11);
+            float32x4_t top = vmlaq_f32(a, vsubq_f32(b, a), fx);
+            float32x4_t bottom = vmlaq_f32(c, vsubq_f32(d, c), fx);
+            float32x4_t value = vaddq_f32(vmlaq_f32(top, vsubq_f32(bottom, top), fy), half);
+            value = vbslq_f32(vcgtq_f32(W, zero), value, vdupq_n_f32(Fill));
+            uint16x4_t narrow = vqmovn_u32(vcvtq_u32_f32(value));
+            uint8x8_t bytes = vqmovn_u16(vcombine_u16(narrow, narrow));
+            vst1_lane_u32(reinterpret_cast<uint32_t *>(dst + i), vreinterpret_u32_u8(bytes), 0);
+        }
+#endif
+        for (; i < size; i++)
+        {
+            const float W = W0 + i * dW;
+            dst[i] = W > 0 ? bilinear((X0 + i * dX) / W - 0.5f, (Y0 + i * dY) / W - 0.5f) : Fill;
+        }
+    }
+
+    return { buffer.data(), size, size, ImageFormat::Lum };
+}
+
+RectifyDecoder::Stats RectifyDecoder::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+void RectifyDecoder::resetStats()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats = {};
+}
+
+void RectifyDecoder::record(int candidates, bool hit, double ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats.attempts++;
+    m_stats.candidates += candidates;
+    m_stats.hits += hit ? 1 : 0;
+    m_stats.totalTime += ms;
+}
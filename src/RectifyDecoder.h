@@ -0,0 +1,61 @@
+#pragma once
+
+#include <ZXing/ReadBarcode.h>
+#include <QDeadlineTimer>
+#include <QMutex>
+#include <vector>
+
+// 透视校正重试
+// 常规识别启用返回错误结果，未识别到条码时取其中已定位但未能解码的二维码区域，
+// 将该区域双线性插值透视变换为正视、紧凑裁剪的小图，再按纯净图像识别；
+// 倾斜角度较大的条码无需对整帧进行深度扫描即可识别
+class RectifyDecoder
+{
+public:
+    struct Stats
+    {
+        quint64 attempts = 0;   // 进行校正的帧数
+        quint64 candidates = 0; // 校正的候选区域数
+        quint64 hits = 0;       // 校正后识别到结果的帧数
+        double totalTime = 0.0; // 累计耗时(ms)
+    };
+
+    // 校正图像中条码区域的边长范围(px)
+    static constexpr int MinSide = 32;
+    static constexpr int MaxSide = 1024;
+    // 每帧最多校正的候选区域数
+    static constexpr int MaxCandidates = 4;
+
+    // 单位正方形到四边形的透视变换：x = (a*u + b*v + c) / w, y = (d*u + e*v + f) / w, w = g*u + h*v + 1
+    struct Homography
+    {
+        double a = 1, b = 0, c = 0;
+        double d = 0, e = 1, f = 0;
+        double g = 0, h = 0;
+
+        // quad依次对应(0,0)、(1,0)、(1,1)、(0,1)，四边形退化时返回false
+        bool fromQuad(const ZXing::QuadrilateralI &quad);
+        ZXing::PointF map(double u, double v) const;
+    };
+
+    RectifyDecoder() = default;
+
+    // candidates为常规识别在image中返回的未能解码的条码，options为常规识别使用的参数；
+    // 返回结果的坐标为image中的坐标，可在任意线程调用；超过截止时间后不再校正其余候选区域
+    ZXing::Barcodes decode(const ZXing::ImageView &image, const ZXing::Barcodes &candidates, const ZXing::ReaderOptions &options,
+        QDeadlineTimer deadline = QDeadlineTimer(QDeadlineTimer::Forever));
+
+    Stats stats() const;
+    void resetStats();
+
+    // 将homography映射的四边形区域变换为边长side的正方形，四周各留margin像素，
+    // buffer为输出的灰度图像内存；映射到视平线另一侧的像素填充为白色
+    static ZXing::ImageView warp(const ZXing::ImageView &image, const Homography &homography, int side, int margin,
+        std::vector<uint8_t> &buffer);
+
+private:
+    void record(int candidates, bool hit, double ms);
+
+    mutable QMutex m_mutex;
+    Stats m_stats;
+};
@@ -0,0 +1,212 @@
+#include "ResultCache.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <cstring>
+
+// 磁盘缓存文件格式版本
+static constexpr quint32 CacheVersion = 1;
+
+// 64位乘法混合哈希，每次处理8字节
+static quint64 HashBytes(const uint8_t *data, size_t size, quint64 seed)
+{
+    constexpr quint64 m = 0xc6a4a7935bd1e995ULL;
+    constexpr int r = 47;
+    quint64 h = seed ^ (size * m);
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        quint64 k;
+        std::memcpy(&k, data + i, 8);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+    if (i < size)
+    {
+        quint64 k = 0;
+        std::memcpy(&k, data + i, size - i);
+        h ^= k;
+        h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+ResultCache::ResultCache(int capacity)
+    : m_cache(capacity)
+{
+}
+
+void ResultCache::setDirectory(const QString &dir)
+{
+    int files = 0;
+    if (!dir.isEmpty())
+    {
+        QDir().mkpath(dir);
+        files = prune(dir, DiskCapacity);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_dir = dir;
+    m_diskFiles = files;
+}
+
+QString ResultCache::directory() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_dir;
+}
+
+QByteArray ResultCache::key(const ZXing::ImageView &image, const ZXing::ReaderOptions &options, quint32 extra)
+{
+    // 逐行计算，忽略行尾填充字节
+    const size_t rowBytes = static_cast<size_t>(image.width()) * image.pixStride();
+    quint64 h = 0x9e3779b97f4a7c15ULL;
+    for (int y = 0; y < image.height(); y++)
+        h = HashBytes(image.data(0, y), rowBytes, h);
+
+    // 影响识别结果的尺寸、格式与参数
+    quint32 formats = 0;
+    for (auto format : options.formats())
+        formats |= static_cast<quint32>(format);
+
+    QByteArray params;
+    QDataStream stream(&params, QIODevice::WriteOnly);
+    stream << image.width() << image.height() << static_cast<quint32>(image.format()) << formats
+           << options.tryHarder() << options.tryRotate() << options.tryInvert() << options.tryDownscale()
+           << options.tryDenoise() << static_cast<quint32>(options.binarizer())
+           << options.downscaleThreshold() << options.downscaleFactor() << options.isPure()
+           << static_cast<quint32>(options.textMode()) << options.maxNumberOfSymbols() << extra;
+    h = HashBytes(reinterpret_cast<const uint8_t *>(params.constData()), params.size(), h);
+
+    return QByteArray::number(h, 16).rightJustified(16, '0');
+}
+
+bool ResultCache::find(const QByteArray &key, Entry &entry)
+{
+    QMutexLocker locker(&m_mutex);
+    if (auto cached = m_cache.object(key))
+    {
+        entry = *cached;
+        m_hits++;
+        return true;
+    }
+    QString dir = m_dir;
+    locker.unlock();
+
+    // 内存中未找到时读取磁盘缓存，读取期间不占用锁
+    Entry loaded;
+    bool ok = false;
+    if (!dir.isEmpty())
+    {
+        QFile file(filePath(dir, key));
+        if (file.open(QIODevice::ReadOnly))
+        {
+            QDataStream stream(&file);
+            quint32 version = 0;
+            stream >> version;
+            if (version == CacheVersion)
+            {
+                stream >> loaded.texts >> loaded.types >> loaded.rects;
+                ok = stream.status() == QDataStream::Ok;
+            }
+        }
+    }
+
+    locker.relock();
+    if (!ok)
+    {
+        m_misses++;
+        return false;
+    }
+    entry = loaded;
+    m_cache.insert(key, new Entry(loaded));
+    m_diskHits++;
+    return true;
+}
+
+void ResultCache::insert(const QByteArray &key, const Entry &entry)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.insert(key, new Entry(entry));
+    QString dir = m_dir;
+    locker.unlock();
+
+    if (dir.isEmpty())
+        return;
+
+    // 先写入临时文件再替换，避免中断时留下不完整的缓存
+    QSaveFile file(filePath(dir, key));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    QDataStream stream(&file);
+    stream << CacheVersion << entry.texts << entry.types << entry.rects;
+    if (!file.commit())
+        return;
+
+    // 超出上限一定数量后才清理，避免每次写入都遍历目录
+    locker.relock();
+    bool full = ++m_diskFiles > DiskCapacity + DiskCapacity / 8;
+    if (full)
+        m_diskFiles = DiskCapacity;
+    locker.unlock();
+    if (full)
+        prune(dir, DiskCapacity);
+}
+
+void ResultCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.clear();
+    m_hits = 0;
+    m_diskHits = 0;
+    m_misses = 0;
+    m_diskFiles = 0;
+    QString dir = m_dir;
+    locker.unlock();
+
+    if (!dir.isEmpty())
+        prune(dir, 0);
+}
+
+quint64 ResultCache::hits() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hits;
+}
+
+quint64 ResultCache::diskHits() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_diskHits;
+}
+
+quint64 ResultCache::misses() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_misses;
+}
+
+QString ResultCache::filePath(const QString &dir, const QByteArray &key)
+{
+    return dir + '/' + QString::fromLatin1(key) + ".cache";
+}
+
+int ResultCache::prune(const QString &dir, int keep)
+{
+    // 按修改时间由新到旧排列
+    auto files = QDir(dir).entryInfoList({ "*.cache" }, QDir::Files, QDir::Time);
+    for (int i = keep; i < files.size(); i++)
+        QFile::remove(files[i].filePath());
+    return qMin(keep, static_cast<int>(files.size()));
+}
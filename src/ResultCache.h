@@ -0,0 +1,61 @@
+#pragma once
+
+#include <ZXing/ImageView.h>
+#include <ZXing/ReaderOptions.h>
+#include <QByteArray>
+#include <QCache>
+#include <QList>
+#include <QMutex>
+#include <QPolygon>
+#include <QString>
+#include <QStringList>
+
+// 识别结果缓存
+// 以像素数据与识别参数的哈希值为键，内存中按最近最少使用淘汰；
+// 设置了缓存目录时结果同时保存到磁盘，重新扫描未改变的图片可直接得到结果；
+// 磁盘缓存的文件数超过上限时删除最早写入的文件
+class ResultCache
+{
+public:
+    // 磁盘缓存最多保存的文件数
+    static constexpr int DiskCapacity = 4096;
+
+    struct Entry
+    {
+        QStringList texts;
+        QStringList types;
+        QList<QPolygon> rects;
+    };
+
+    explicit ResultCache(int capacity = 256);
+
+    // 磁盘缓存目录，为空时只使用内存缓存；设置时删除超出上限的旧文件
+    void setDirectory(const QString &dir);
+    QString directory() const;
+
+    // 计算图像与参数的键，可在任意线程调用；extra为其它影响结果的设置
+    static QByteArray key(const ZXing::ImageView &image, const ZXing::ReaderOptions &options, quint32 extra = 0);
+
+    // 查找结果，未找到时返回false，可在任意线程调用
+    bool find(const QByteArray &key, Entry &entry);
+    void insert(const QByteArray &key, const Entry &entry);
+    // 清除内存与磁盘中的全部结果及命中统计
+    void clear();
+
+    quint64 hits() const;
+    quint64 diskHits() const;
+    quint64 misses() const;
+
+private:
+    static QString filePath(const QString &dir, const QByteArray &key);
+    // 按写入时间保留最新的keep个缓存文件，返回剩余的文件数
+    static int prune(const QString &dir, int keep);
+
+    mutable QMutex m_mutex;
+    QCache<QByteArray, Entry> m_cache;
+    QString m_dir;
+    int m_diskFiles = 0;    // 磁盘缓存的文件数，写入时累加，清理后重新统计
+    quint64 m_hits = 0;
+    quint64 m_diskHits = 0;
+    quint64 m_misses = 0;
+};
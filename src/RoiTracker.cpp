@@ -0,0 +1,59 @@
+#include "RoiTracker.h"
+#include <QMutexLocker>
+
+QRect RoiTracker::region(const QSize &frameSize, int fullInterval)
+{
+    QMutexLocker locker(&m_mutex);
+    auto roi = m_last.intersected(QRect(QPoint(0, 0), frameSize));
+    // 无跟踪目标、到达整帧间隔或区域已覆盖大部分画面时识别整帧
+    if (roi.isEmpty() || m_sinceFull + 1 >= qMax(1, fullInterval)
+        || qint64(roi.width()) * roi.height() * 2 > qint64(frameSize.width()) * frameSize.height())
+    {
+        m_sinceFull = 0;
+        m_fullFrames++;
+        return QRect();
+    }
+
+    m_sinceFull++;
+    m_roiFrames++;
+    return roi;
+}
+
+void RoiTracker::update(const QList<QPolygon> &hits, double margin)
+{
+    QMutexLocker locker(&m_mutex);
+    // 未识别到时丢失跟踪，下一帧识别整帧
+    if (hits.isEmpty())
+    {
+        m_last = QRect();
+        return;
+    }
+
+    QRect box;
+    for (auto &hit : hits)
+        box |= hit.boundingRect();
+
+    margin = qMax(0.0, margin);
+    int dx = static_cast<int>(box.width() * margin);
+    int dy = static_cast<int>(box.height() * margin);
+    m_last = box.adjusted(-dx, -dy, dx, dy);
+}
+
+void RoiTracker::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_last = QRect();
+    m_sinceFull = 0;
+}
+
+quint64 RoiTracker::roiFrames() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_roiFrames;
+}
+
+quint64 RoiTracker::fullFrames() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_fullFrames;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QList>
+#include <QMutex>
+#include <QPolygon>
+#include <QRect>
+#include <QSize>
+
+// 识别区域跟踪
+// 识别到条码后，后续帧只识别上次位置外扩的区域；
+// 每隔若干帧或在区域内未识别到时回退到整帧识别
+class RoiTracker
+{
+public:
+    RoiTracker() = default;
+
+    // 返回本帧需识别的区域，空矩形表示识别整帧；fullInterval为每隔多少帧强制识别一次整帧
+    QRect region(const QSize &frameSize, int fullInterval);
+    // 记录本帧识别结果，hits为整帧坐标下的条码位置，margin为区域外扩比例，相对于条码外接矩形的宽高
+    void update(const QList<QPolygon> &hits, double margin);
+    void reset();
+
+    quint64 roiFrames() const;      // 区域识别的帧数
+    quint64 fullFrames() const;     // 整帧识别的帧数
+
+private:
+    mutable QMutex m_mutex;
+    QRect m_last;           // 上次条码的外接矩形（已外扩）
+    int m_sinceFull = 0;    // 距上次整帧识别的帧数
+    quint64 m_roiFrames = 0;
+    quint64 m_fullFrames = 0;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QCamera>
+#include <QPointer>
+#include <QString>
+
+#include "BinarizerTuner.h"
+#include "DownscaleTuner.h"
+#include "FrameGate.h"
+#include "FrameMailbox.h"
+#include "Preprocessor.h"
+#include "RoiTracker.h"
+#include "ScanScheduler.h"
+
+// 一路相机的识别通道，每路相机独立限流、调度与跟踪
+// 由识别任务共享持有，相机对象仅由GUI线程创建与删除
+struct ScanLane
+{
+    explicit ScanLane(const QString &name) : name(name) {}
+
+    // 开始采集前清除上一次的统计状态，二值化算法的选择与条码尺寸跨次保留
+    void reset()
+    {
+        mailbox.clear();
+        scheduler.reset();
+        tracker.reset();
+        gate.reset();
+    }
+
+    const QString name;
+    QPointer<QCamera> camera;   // 附加相机，主相机为空
+    FrameMailbox mailbox;       // 帧信箱
+    ScanScheduler scheduler;    // 采集间隔调度
+    RoiTracker tracker;         // 识别区域跟踪
+    FrameGate gate;             // 画面变化门限
+    BinarizerTuner binarizer;   // 二值化算法自动选择
+    DownscaleTuner downscale;   // 缩小识别参数自动调整
+    Preprocessor preprocess;    // 预处理耗时统计
+    quint64 lastProcessed = 0;  // 上次统计时已识别的帧数，仅GUI线程访问
+};
@@ -0,0 +1,93 @@
+#include "ScanScheduler.h"
+#include <QMutexLocker>
+#include <algorithm>
+
+// 移动平均的平滑系数
+static constexpr double kSmoothing = 0.2;
+
+ScanScheduler::ScanScheduler()
+{
+    m_clock.start();
+}
+
+void ScanScheduler::setCpuBudget(double budget)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cpuBudget = std::clamp(budget, 0.01, 1.0);
+}
+
+double ScanScheduler::cpuBudget() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cpuBudget;
+}
+
+void ScanScheduler::setTargetLatency(int ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_targetLatency = qMax(0, ms);
+}
+
+void ScanScheduler::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_clock.restart();
+    m_avgTime = 0.0;
+    m_hasSample = false;
+    m_lastHit = 0;
+    m_lastAccept = -1;
+}
+
+void ScanScheduler::addSample(qint64 elapsedMs, bool found)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_hasSample)
+        m_avgTime += kSmoothing * (elapsedMs - m_avgTime);
+    else
+        m_avgTime = elapsedMs;
+    m_hasSample = true;
+
+    if (found)
+        m_lastHit = m_clock.elapsed();
+}
+
+int ScanScheduler::interval() const
+{
+    QMutexLocker locker(&m_mutex);
+    return intervalLocked();
+}
+
+bool ScanScheduler::accept()
+{
+    QMutexLocker locker(&m_mutex);
+    auto now = m_clock.elapsed();
+    if (m_lastAccept >= 0 && now - m_lastAccept < intervalLocked())
+        return false;
+    m_lastAccept = now;
+    return true;
+}
+
+double ScanScheduler::averageTime() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_avgTime;
+}
+
+int ScanScheduler::intervalLocked() const
+{
+    // 按CPU预算计算间隔：识别耗时占采集周期的比例不超过预算
+    double interval = m_avgTime / m_cpuBudget;
+    // 满足目标延迟：等待下一次采集的时间加上识别耗时
+    if (m_targetLatency > 0)
+        interval = std::min(interval, std::max(0.0, m_targetLatency - m_avgTime));
+
+    // 每经过一个空闲超时时长，采集间隔翻倍，最多放慢8倍
+    auto idle = m_clock.elapsed() - m_lastHit;
+    if (idle > m_idleTimeout)
+    {
+        int backoff = 1 << std::min<qint64>(idle / m_idleTimeout, 3);
+        interval = std::max<double>(interval, m_minInterval) * backoff;
+    }
+
+    return std::clamp(static_cast<int>(interval), m_minInterval, m_maxInterval);
+}
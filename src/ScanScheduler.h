@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QMutex>
+
+// 根据实测识别耗时自适应调整采集间隔
+// 识别耗时取指数移动平均，间隔 = 平均耗时 / CPU预算，可选目标延迟上限；
+// 长时间未识别到结果时逐级放慢采集
+class ScanScheduler
+{
+public:
+    ScanScheduler();
+
+    // CPU预算：识别占用单核的比例 (0, 1]
+    void setCpuBudget(double budget);
+    double cpuBudget() const;
+    // 目标延迟(ms)，采集间隔与识别耗时之和不超过该值，0表示不限制
+    void setTargetLatency(int ms);
+
+    // 重新开始统计，如开始采集或识别参数改变时
+    void reset();
+    // 记录一次识别耗时与是否识别成功，可在任意线程调用
+    void addSample(qint64 elapsedMs, bool found);
+    // 当前采集间隔(ms)
+    int interval() const;
+    // 视频流模式下判断当前帧是否需要识别，距上次接受的帧不足一个间隔时返回false
+    bool accept();
+    // 平均识别耗时(ms)
+    double averageTime() const;
+
+private:
+    int intervalLocked() const;
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;      // 自reset()起的计时
+    double m_avgTime = 0.0;     // 识别耗时移动平均
+    bool m_hasSample = false;
+    qint64 m_lastHit = 0;       // 最近一次识别成功的时间
+    qint64 m_lastAccept = -1;   // 最近一次接受帧的时间
+    double m_cpuBudget = 0.5;
+    int m_targetLatency = 0;
+    int m_minInterval = 30;     // 采集间隔范围(ms)
+    int m_maxInterval = 3000;
+    int m_idleTimeout = 5000;   // 未识别到结果超过该时长(ms)后开始放慢采集
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ZXing/ReaderOptions.h>
+#include <memory>
+
+// 识别设置快照
+// 在GUI线程中根据控件状态构建，整体发布后只读，识别线程不访问任何控件
+struct ScanSettings
+{
+    ZXing::ReaderOptions options;
+    bool cascade = true;        // 分级识别
+    bool parallel = false;      // 旋转与反色变体并行识别
+    bool tiled = true;          // 超大图片分块识别
+    int pyramidLevels = 1;      // 多尺度识别的尺度数，1为仅识别原图
+    bool autoDownscale = true;  // 相机帧按帧尺寸与条码尺寸自动调整缩小识别参数
+    int preprocess = 0;         // 识别前的预处理滤波器(Preprocessor::Filter)，0为不预处理
+    bool preprocessAlways = false;  // 总是预处理，否则仅在原图未识别到时预处理后再识别
+    bool rectify = true;        // 未识别到时对已定位的二维码透视校正后再识别
+    bool formatPriority = true; // 优先识别常见格式
+    bool resultCache = true;    // 缓存图片文件的识别结果
+    int binarizer = -1;         // 指定的二值化算法(ZXing::Binarizer)，-1为各相机自动选择
+    int frameDeadline = 500;    // 相机帧从采集起的识别截止时间(ms)，0为不限
+    bool continuous = false;    // 连续扫描，识别后不停止相机
+    bool tracking = true;       // 跟踪上次识别的区域
+    int trackingInterval = 10;  // 跟踪时每隔多少帧识别一次整帧
+    int trackingMargin = 50;    // 跟踪区域相对条码外接矩形的外扩比例(%)
+    bool changeGate = true;     // 跳过无变化的画面
+};
+
+using ScanSettingsPtr = std::shared_ptr<const ScanSettings>;
@@ -0,0 +1,73 @@
+#include "SequenceAssembler.h"
+#include <QMutexLocker>
+
+SequenceAssembler::SequenceAssembler()
+{
+    m_clock.start();
+}
+
+void SequenceAssembler::setTimeout(int ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_timeout = qMax(0, ms);
+}
+
+ZXing::Barcodes SequenceAssembler::add(const ZXing::Barcodes &barcodes)
+{
+    QMutexLocker locker(&m_mutex);
+    auto now = m_clock.elapsed();
+    expireLocked(now);
+
+    ZXing::Barcodes merged;
+    for (auto &barcode : barcodes)
+    {
+        // 总数未知或没有序列ID的部分无法判断何时到齐
+        if (!barcode.isPartOfSequence() || barcode.sequenceSize() <= 0 || barcode.sequenceId().empty())
+            continue;
+
+        auto key = QString::fromStdString(ZXing::ToString(barcode.format()) + " " + barcode.sequenceId());
+        auto &sequence = m_sequences[key];
+        sequence.size = barcode.sequenceSize();
+        sequence.parts[barcode.sequenceIndex()] = barcode;
+        sequence.updated = now;
+
+        if (static_cast<int>(sequence.parts.size()) < sequence.size)
+            continue;
+
+        ZXing::Barcodes parts;
+        for (auto &[index, part] : sequence.parts)
+            parts.push_back(part);
+        m_sequences.remove(key);
+
+        auto result = ZXing::MergeStructuredAppendSequence(parts);
+        if (result.isValid())
+            merged.push_back(std::move(result));
+    }
+    return merged;
+}
+
+void SequenceAssembler::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_sequences.clear();
+}
+
+QStringList SequenceAssembler::pending() const
+{
+    QMutexLocker locker(&m_mutex);
+    QStringList list;
+    for (auto it = m_sequences.cbegin(); it != m_sequences.cend(); ++it)
+        list << QString("%1 %2/%3").arg(it.key()).arg(it.value().parts.size()).arg(it.value().size);
+    return list;
+}
+
+void SequenceAssembler::expireLocked(qint64 now)
+{
+    for (auto it = m_sequences.begin(); it != m_sequences.end();)
+    {
+        if (now - it.value().updated > m_timeout)
+            it = m_sequences.erase(it);
+        else
+            ++it;
+    }
+}
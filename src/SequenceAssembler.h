@@ -0,0 +1,43 @@
+#pragma once
+
+#include <ZXing/Barcode.h>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <map>
+
+// 结构化追加条码拼接
+// 按格式与序列ID收集跨帧、跨图片识别到的各个部分，全部部分到齐后合并为完整内容；
+// 超过时间未更新的不完整序列被丢弃，使内存占用有界
+class SequenceAssembler
+{
+public:
+    SequenceAssembler();
+
+    // 不完整序列的保留时间(ms)
+    void setTimeout(int ms);
+
+    // 加入识别结果中的序列部分，返回本次完成合并的结果，可在任意线程调用
+    ZXing::Barcodes add(const ZXing::Barcodes &barcodes);
+    void clear();
+
+    // 正在收集的序列，格式为"格式 ID 已收集/总数"
+    QStringList pending() const;
+
+private:
+    struct Sequence
+    {
+        std::map<int, ZXing::Barcode> parts;    // 按序号排列的部分
+        int size = 0;
+        qint64 updated = 0;
+    };
+
+    void expireLocked(qint64 now);
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    QHash<QString, Sequence> m_sequences;
+    int m_timeout = 30000;
+};
@@ -0,0 +1,90 @@
+#include "TiledDecoder.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+struct Tile
+{
+    ZXing::ImageView view;
+    int left = 0;
+    int top = 0;
+    int scale = 1;  // 缩小的整图
+};
+
+// 分块起点，最后一块与图像边缘对齐
+std::vector<int> TileStarts(int length, int tileSize, int overlap)
+{
+    std::vector<int> starts;
+    if (length <= tileSize)
+        return { 0 };
+    int step = std::max(1, tileSize - overlap);
+    for (int s = 0; s + tileSize < length; s += step)
+        starts.push_back(s);
+    starts.push_back(length - tileSize);
+    return starts;
+}
+
+// 相同内容与格式且位置重叠的条码视为重复
+bool IsDuplicate(const ZXing::Barcode &a, const ZXing::Barcode &b)
+{
+    return a.format() == b.format() && a.bytes() == b.bytes()
+        && ZXing::HaveIntersectingBoundingBoxes(a.position(), b.position());
+}
+
+} // namespace
+
+bool TiledDecoder::shouldTile(const ZXing::ImageView &image)
+{
+    return qint64(image.width()) * image.height() > MinPixels;
+}
+
+ZXing::Barcodes TiledDecoder::decode(const ZXing::ImageView &image, const DecodeFunc &decodeTile,
+    int tileSize, int overlap, QThreadPool *pool)
+{
+    std::vector<Tile> tiles;
+    for (int top : TileStarts(image.height(), tileSize, overlap))
+    {
+        for (int left : TileStarts(image.width(), tileSize, overlap))
+            tiles.push_back({ image.cropped(left, top, tileSize, tileSize), left, top, 1 });
+    }
+
+    // 缩小到约一个分块大小的整图，识别超过重叠宽度的大尺寸条码
+    int scale = (std::max(image.width(), image.height()) + tileSize - 1) / tileSize;
+    if (scale > 1)
+        tiles.push_back({ image.subsampled(scale), 0, 0, scale });
+
+    std::vector<ZXing::Barcodes> results(tiles.size());
+    ParallelFor(static_cast<int>(tiles.size()), [&](int i) {
+        try
+        {
+            results[i] = decodeTile(tiles[i].view);
+        }
+        catch (...)
+        {
+        }
+        return false;
+        }, pool);
+
+    ZXing::Barcodes merged;
+    for (size_t i = 0; i < tiles.size(); i++)
+    {
+        auto &tile = tiles[i];
+        for (auto &result : results[i])
+        {
+            // 分块坐标转换为原图坐标
+            auto pos = result.position();
+            for (auto &p : pos)
+                p = tile.scale * p + ZXing::PointI(tile.left, tile.top);
+            result.setPosition(pos);
+
+            bool duplicate = std::any_of(merged.begin(), merged.end(), [&](const ZXing::Barcode &b) {
+                return IsDuplicate(b, result);
+                });
+            if (!duplicate)
+                merged.push_back(std::move(result));
+        }
+    }
+    return merged;
+}
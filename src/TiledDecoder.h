@@ -0,0 +1,25 @@
+#pragma once
+
+#include <ZXing/ReadBarcode.h>
+#include <QtGlobal>
+#include <functional>
+
+class QThreadPool;
+
+// 超大图像分块并行识别
+// 将图像分为互相重叠的分块并行识别，另以缩小的整图识别跨越多个分块的大尺寸条码，
+// 结果坐标转换回原图坐标，并去除重叠区域内重复识别的条码
+class TiledDecoder
+{
+public:
+    using DecodeFunc = std::function<ZXing::Barcodes(const ZXing::ImageView &)>;
+
+    // 超过该像素数的图像使用分块识别
+    static constexpr qint64 MinPixels = 16'000'000;
+
+    static bool shouldTile(const ZXing::ImageView &image);
+
+    // tileSize为分块边长，overlap为相邻分块的重叠宽度，应不小于待识别的小尺寸条码边长
+    static ZXing::Barcodes decode(const ZXing::ImageView &image, const DecodeFunc &decodeTile,
+        int tileSize = 2048, int overlap = 256, QThreadPool *pool = nullptr);
+};
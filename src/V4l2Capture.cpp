@@ -0,0 +1,297 @@
+#include "V4l2Capture.h"
+#include "FrameView.h"
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QThread>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <linux/videodev2.h>
+
+namespace {
+
+// 申请的驱动缓冲区数，识别中的帧占用缓冲区期间其余缓冲区继续采集
+constexpr unsigned BufferCount = 4;
+// 重新打开时等待上一次采集的帧释放的最长时间(ms)
+constexpr int ReleaseTimeout = 2000;
+
+// 被信号中断时重试的ioctl
+int Ioctl(int fd, unsigned long request, void *arg)
+{
+    int r;
+    do
+    {
+        r = ioctl(fd, request, arg);
+    } while (r == -1 && errno == EINTR);
+    return r;
+}
+
+QString ErrnoString(const char *what)
+{
+    return QStringLiteral("%1: %2").arg(what, QString::fromLocal8Bit(strerror(errno)));
+}
+
+} // namespace
+
+// 设备文件与映射的缓冲区，由采集对象与所有未释放的帧共同持有
+struct V4l2Capture::Device
+{
+    ~Device()
+    {
+        for (auto &buffer : buffers)
+        {
+            if (buffer.data != MAP_FAILED)
+                munmap(buffer.data, buffer.length);
+        }
+        if (fd >= 0)
+            close(fd);
+    }
+
+    // 帧释放后缓冲区重新入队，停止采集后不再入队
+    void requeue(unsigned index)
+    {
+        if (!streaming)
+            return;
+        v4l2_buffer buf {};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = index;
+        Ioctl(fd, VIDIOC_QBUF, &buf);
+    }
+
+    struct Buffer
+    {
+        void *data = MAP_FAILED;
+        size_t length = 0;
+    };
+
+    int fd = -1;
+    std::vector<Buffer> buffers;
+    std::atomic<bool> streaming { false };
+    int width = 0;
+    int height = 0;
+    int rowStride = 0;
+    int pixStride = 1;  // YUYV的Y分量间隔2字节
+};
+
+V4l2Capture::V4l2Capture(QObject *parent)
+    : QObject(parent)
+{
+}
+
+V4l2Capture::~V4l2Capture()
+{
+    stop();
+}
+
+bool V4l2Capture::start(const QString &device, const FrameHandler &handler)
+{
+    stop();
+    m_error.clear();
+
+    // 上一次采集的帧仍在识别时设备尚未解除映射并关闭，驱动拒绝再次申请缓冲区，等待其释放
+    QDeadlineTimer timeout(ReleaseTimeout);
+    while (!m_previous.expired() && !timeout.hasExpired())
+        QThread::msleep(10);
+    if (!m_previous.expired())
+    {
+        m_error = tr("上一次采集的帧仍在识别中，请稍后重试");
+        return false;
+    }
+
+    auto dev = std::make_shared<Device>();
+    dev->fd = open(device.toLocal8Bit().constData(), O_RDWR | O_NONBLOCK);
+    if (dev->fd < 0)
+    {
+        m_error = ErrnoString("open");
+        return false;
+    }
+
+    v4l2_capability cap {};
+    if (Ioctl(dev->fd, VIDIOC_QUERYCAP, &cap) < 0)
+    {
+        m_error = ErrnoString("VIDIOC_QUERYCAP");
+        return false;
+    }
+    auto caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps & V4L2_CAP_STREAMING))
+    {
+        m_error = tr("设备不支持单平面视频流采集");
+        return false;
+    }
+
+    // 保持设备当前的分辨率，依次尝试Y分量可直接引用的像素格式
+    v4l2_format fmt {};
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (Ioctl(dev->fd, VIDIOC_G_FMT, &fmt) < 0)
+    {
+        m_error = ErrnoString("VIDIOC_G_FMT");
+        return false;
+    }
+    const struct
+    {
+        quint32 pixelFormat;
+        int pixStride;
+        const char *name;
+    } formats[] = {
+        { V4L2_PIX_FMT_GREY, 1, "GREY" },
+        { V4L2_PIX_FMT_YUYV, 2, "YUYV" },
+        { V4L2_PIX_FMT_NV12, 1, "NV12" },
+    };
+    bool negotiated = false;
+    for (auto &f : formats)
+    {
+        fmt.fmt.pix.pixelformat = f.pixelFormat;
+        fmt.fmt.pix.field = V4L2_FIELD_NONE;
+        if (Ioctl(dev->fd, VIDIOC_S_FMT, &fmt) == 0 && fmt.fmt.pix.pixelformat == f.pixelFormat)
+        {
+            dev->pixStride = f.pixStride;
+            m_formatName = QString::fromLatin1(f.name);
+            negotiated = true;
+            break;
+        }
+    }
+    if (!negotiated)
+    {
+        m_error = tr("设备不支持GREY/YUYV/NV12格式");
+        return false;
+    }
+    dev->width = static_cast<int>(fmt.fmt.pix.width);
+    dev->height = static_cast<int>(fmt.fmt.pix.height);
+    dev->rowStride = fmt.fmt.pix.bytesperline ? static_cast<int>(fmt.fmt.pix.bytesperline) : dev->width * dev->pixStride;
+
+    // 申请并映射驱动缓冲区
+    v4l2_requestbuffers req {};
+    req.count = BufferCount;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (Ioctl(dev->fd, VIDIOC_REQBUFS, &req) < 0 || req.count < 2)
+    {
+        m_error = errno == EBUSY ? tr("设备正被其它程序占用") : ErrnoString("VIDIOC_REQBUFS");
+        return false;
+    }
+    dev->buffers.resize(req.count);
+    for (unsigned i = 0; i < req.count; i++)
+    {
+        v4l2_buffer buf {};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (Ioctl(dev->fd, VIDIOC_QUERYBUF, &buf) < 0)
+        {
+            m_error = ErrnoString("VIDIOC_QUERYBUF");
+            return false;
+        }
+        auto &buffer = dev->buffers[i];
+        buffer.length = buf.length;
+        buffer.data = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, dev->fd, buf.m.offset);
+        if (buffer.data == MAP_FAILED)
+        {
+            m_error = ErrnoString("mmap");
+            return false;
+        }
+        if (Ioctl(dev->fd, VIDIOC_QBUF, &buf) < 0)
+        {
+            m_error = ErrnoString("VIDIOC_QBUF");
+            return false;
+        }
+    }
+
+    auto type = static_cast<int>(V4L2_BUF_TYPE_VIDEO_CAPTURE);
+    if (Ioctl(dev->fd, VIDIOC_STREAMON, &type) < 0)
+    {
+        m_error = ErrnoString("VIDIOC_STREAMON");
+        return false;
+    }
+    dev->streaming = true;
+
+    m_device = dev;
+    m_running = true;
+    m_thread = QThread::create([this, dev, handler] { run(dev, handler); });
+    m_thread->start();
+    return true;
+}
+
+void V4l2Capture::stop()
+{
+    if (!m_thread)
+        return;
+
+    m_running = false;
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+    // 停止后驱动收回所有缓冲区，识别中的帧仍可访问映射内存直到释放
+    m_device->streaming = false;
+    auto type = static_cast<int>(V4L2_BUF_TYPE_VIDEO_CAPTURE);
+    Ioctl(m_device->fd, VIDIOC_STREAMOFF, &type);
+    m_previous = m_device;
+    m_device.reset();
+}
+
+bool V4l2Capture::isActive() const
+{
+    return m_thread != nullptr && m_running;
+}
+
+void V4l2Capture::run(std::shared_ptr<Device> device, FrameHandler handler)
+{
+    QElapsedTimer previewTimer;
+    previewTimer.start();
+
+    while (m_running)
+    {
+        // 定时唤醒以便及时响应停止
+        pollfd pfd { device->fd, POLLIN, 0 };
+        int r = poll(&pfd, 1, 100);
+        if (r < 0 && errno != EINTR)
+        {
+            emit errorOccurred(ErrnoString("poll"));
+            break;
+        }
+        if (r <= 0)
+            continue;
+
+        v4l2_buffer buf {};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        if (Ioctl(device->fd, VIDIOC_DQBUF, &buf) < 0)
+        {
+            // 所有缓冲区都在识别中时暂无可取的帧
+            if (errno == EAGAIN)
+                continue;
+            emit errorOccurred(ErrnoString("VIDIOC_DQBUF"));
+            break;
+        }
+        if (buf.flags & V4L2_BUF_FLAG_ERROR)
+        {
+            device->requeue(buf.index);
+            continue;
+        }
+
+        // 帧持有设备的引用，释放时缓冲区重新入队
+        auto data = static_cast<const uint8_t *>(device->buffers[buf.index].data);
+        unsigned index = buf.index;
+        Frame frame(new ZXing::ImageView(data, device->width, device->height, ZXing::ImageFormat::Lum,
+            device->rowStride, device->pixStride), [device, index](const ZXing::ImageView *view) {
+                delete view;
+                device->requeue(index);
+            });
+
+        int interval = m_previewInterval;
+        if (interval > 0 && previewTimer.elapsed() >= interval)
+        {
+            previewTimer.restart();
+            emit previewReady(FrameView::toImage(*frame));
+        }
+        handler(frame);
+    }
+    m_running = false;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <ZXing/ImageView.h>
+#include <QImage>
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class QThread;
+
+// Linux下直接通过V4L2采集
+// 以GREY/YUYV/NV12格式打开设备，驱动缓冲区mmap映射后将Y分量直接包装为ZXing::ImageView，不做转换与复制；
+// 帧的引用全部释放后缓冲区重新入队，设备在最后一帧释放后才解除映射并关闭
+class V4l2Capture : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 采集的帧，引用计数归零时归还给驱动
+    using Frame = std::shared_ptr<const ZXing::ImageView>;
+    // 在采集线程中调用
+    using FrameHandler = std::function<void(const Frame &)>;
+
+    explicit V4l2Capture(QObject *parent = nullptr);
+    ~V4l2Capture();
+
+    // 打开设备开始采集，device为设备路径，如/dev/video0；失败时返回false并可由errorString()获取原因
+    // 上一次采集的帧仍在识别时先等待其释放
+    bool start(const QString &device, const FrameHandler &handler);
+    void stop();
+    bool isActive() const;
+    QString errorString() const { return m_error; }
+    // 协商得到的像素格式名称
+    QString formatName() const { return m_formatName; }
+
+    // 预览图像的发送间隔(ms)，0为不发送
+    void setPreviewInterval(int ms) { m_previewInterval = ms; }
+
+signals:
+    // 按预览间隔发送的灰度图像，在采集线程中发出
+    void previewReady(const QImage &image);
+    // 采集线程中发生错误后停止采集
+    void errorOccurred(const QString &error);
+
+private:
+    struct Device;
+
+    void run(std::shared_ptr<Device> device, FrameHandler handler);
+
+    std::shared_ptr<Device> m_device;
+    std::weak_ptr<Device> m_previous;   // 已停止的设备，帧全部释放后关闭
+    QThread *m_thread = nullptr;
+    std::atomic<bool> m_running { false };
+    std::atomic<int> m_previewInterval { 200 };
+    QString m_error;
+    QString m_formatName;
+};
@@ -0,0 +1,119 @@
+#include "VariantDecoder.h"
+#include "BufferPool.h"
+#include "DecodeResults.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+struct Variant
+{
+    ZXing::ImageView view;
+    int rotation = 0;
+};
+
+// 旋转视图坐标转换为原图坐标，width与height为原图尺寸
+ZXing::PointI Unrotate(ZXing::PointI p, int rotation, int width, int height)
+{
+    switch (rotation)
+    {
+    case 90:  return { p.y, height - 1 - p.x };
+    case 180: return { width - 1 - p.x, height - 1 - p.y };
+    case 270: return { width - 1 - p.y, p.x };
+    }
+    return p;
+}
+
+} // namespace
+
+ZXing::Barcodes VariantDecoder::decode(const ZXing::ImageView &image, const ZXing::ReaderOptions &options, QThreadPool *pool,
+    QDeadlineTimer deadline)
+{
+    auto opts = ZXing::ReaderOptions(options).setTryRotate(false).setTryInvert(false);
+
+    std::vector<int> rotations = { 0 };
+    if (options.tryRotate())
+        rotations = { 0, 90, 180, 270 };
+
+    std::vector<Variant> variants;
+    for (int r : rotations)
+        variants.push_back({ image.rotated(r), r });
+
+    BufferPool::Buffer buffer;
+    if (options.tryInvert())
+    {
+        buffer = BufferPool::local().acquire(static_cast<size_t>(image.width()) * image.height());
+        auto inv = inverted(image, buffer.storage());
+        for (int r : rotations)
+            variants.push_back({ inv.rotated(r), r });
+    }
+
+    if (variants.size() == 1)
+        return ZXing::ReadBarcodes(image, opts);
+
+    // 各变体结果分别保存，任一变体解码成功或超过截止时间后不再开始其余变体
+    std::vector<ZXing::Barcodes> results(variants.size());
+    ParallelFor(static_cast<int>(variants.size()), [&](int i) {
+        if (i > 0 && deadline.hasExpired())
+            return true;
+        try
+        {
+            results[i] = ZXing::ReadBarcodes(variants[i].view, opts);
+        }
+        catch (...)
+        {
+        }
+        return HasValidResult(results[i]);
+        }, pool);
+
+    // 优先返回解码成功的变体，均未成功时返回第一个定位到条码的变体
+    auto chosen = std::find_if(results.begin(), results.end(), HasValidResult);
+    if (chosen == results.end())
+        chosen = std::find_if(results.begin(), results.end(), [](const ZXing::Barcodes &r) { return !r.empty(); });
+    if (chosen == results.end())
+        return {};
+
+    int rotation = variants[chosen - results.begin()].rotation;
+    for (auto &result : *chosen)
+    {
+        auto pos = result.position();
+        for (auto &p : pos)
+            p = Unrotate(p, rotation, image.width(), image.height());
+        result.setPosition(pos);
+    }
+    return std::move(*chosen);
+}
+
+ZXing::ImageView VariantDecoder::inverted(const ZXing::ImageView &image, std::vector<uint8_t> &buffer)
+{
+    const int w = image.width();
+    const int h = image.height();
+    const int ps = image.pixStride();
+    const auto fmt = image.format();
+    buffer.resize(static_cast<size_t>(w) * h);
+
+    for (int y = 0; y < h; y++)
+    {
+        const uint8_t *src = image.data(0, y);
+        uint8_t *dst = buffer.data() + static_cast<size_t>(y) * w;
+        if (fmt == ZXing::ImageFormat::Lum && ps == 1)
+        {
+            for (int x = 0; x < w; x++)
+                dst[x] = 255 - src[x];
+        }
+        else if (fmt == ZXing::ImageFormat::Lum || fmt == ZXing::ImageFormat::LumA)
+        {
+            for (int x = 0; x < w; x++)
+                dst[x] = 255 - src[x * ps];
+        }
+        else
+        {
+            const int r = ZXing::RedIndex(fmt), g = ZXing::GreenIndex(fmt), b = ZXing::BlueIndex(fmt);
+            for (int x = 0; x < w; x++, src += ps)
+                dst[x] = 255 - ZXing::RGBToLum(src[r], src[g], src[b]);
+        }
+    }
+
+    return { buffer.data(), w, h, ZXing::ImageFormat::Lum };
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <ZXing/ReadBarcode.h>
+#include <QDeadlineTimer>
+
+class QThreadPool;
+
+// 旋转与反色变体并行识别
+// 将图像的0/90/180/270度旋转视图及其反色图像分配到多个线程同时识别，
+// 任一变体识别到结果后不再开始其余变体
+class VariantDecoder
+{
+public:
+    // options中的tryRotate与tryInvert决定生成的变体，pool为空时使用全局线程池；
+    // 超过截止时间后不再开始其余变体，原图总是识别
+    static ZXing::Barcodes decode(const ZXing::ImageView &image, const ZXing::ReaderOptions &options, QThreadPool *pool = nullptr,
+        QDeadlineTimer deadline = QDeadlineTimer(QDeadlineTimer::Forever));
+
+    // 生成反色的灰度图像，buffer为图像内存
+    static ZXing::ImageView inverted(const ZXing::ImageView &image, std::vector<uint8_t> &buffer);
+};